@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "common/Logger.hpp"
+#include "core/AssetCooker.h"
+
+static void PrintUsage();
+
+// Usage: AssetCooker [--force] [--quiet] [-j <threads>] [input dir] [output dir]
+int main(int argc, char** argv)
+{
+	std::string input = "res";
+	std::string output = "cooked";
+	unsigned int threads = 0;
+	bool force = false;
+	int positional = 0;
+
+	Logger& logger = Logger::Get();
+	logger.SetLevel(Logger::LEVEL_INFO);
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--force") == 0)
+		{
+			force = true;
+		}
+		else if (std::strcmp(argv[i], "--quiet") == 0)
+		{
+			logger.SetLevel(Logger::LEVEL_WARNING);
+		}
+		else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+		{
+			threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--help") == 0)
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return -1;
+		}
+		else if (positional == 0)
+		{
+			input = argv[i];
+			positional++;
+		}
+		else if (positional == 1)
+		{
+			output = argv[i];
+			positional++;
+		}
+		else
+		{
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	AssetCooker cooker(input, output, threads, force);
+	return cooker.Run() == 0 ? 0 : 1;
+}
+
+static void PrintUsage()
+{
+	std::cout << "Usage: AssetCooker [options] [input dir = res] [output dir = cooked]\n"
+	          << "  --force      ignore the cook database and rebuild everything\n"
+	          << "  --quiet      only report warnings and errors\n"
+	          << "  -j <n>       number of worker threads (default: all cores)\n"
+	          << "  --help       show this message" << std::endl;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Accumulates a file in memory and writes it in one go.
+// The file is written under a temporary name and then renamed, so a crash
+// (or a cook that gets cancelled) never leaves a half written asset behind.
+class BinaryWriter
+{
+public:
+	template <typename T>
+	void Write(const T& value)
+	{
+		WriteBytes(&value, sizeof(T));
+	}
+
+	template <typename T>
+	void WriteArray(const std::vector<T>& values)
+	{
+		if (!values.empty())
+			WriteBytes(values.data(), values.size() * sizeof(T));
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		m_Data.insert(m_Data.end(), bytes, bytes + size);
+	}
+
+	void Reserve(size_t size) { m_Data.reserve(size); }
+
+	bool SaveTo(const std::filesystem::path& path) const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+
+		std::filesystem::path temp = path;
+		temp += ".tmp";
+
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			if (!out)
+				return false;
+			out.write(reinterpret_cast<const char*>(m_Data.data()), m_Data.size());
+			if (!out)
+				return false;
+		}
+
+		std::filesystem::rename(temp, path, ec);
+		return !ec;
+	}
+
+private:
+	std::vector<unsigned char> m_Data;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit FNV-1a, good enough to detect content changes between cooks
+class Hash
+{
+public:
+	static constexpr uint64_t SEED = 14695981039346656037ull;
+
+	static uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = SEED)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	static uint64_t Fnv1a(const std::string& str, uint64_t hash = SEED)
+	{
+		return Fnv1a(str.data(), str.size(), hash);
+	}
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// Same interface as the renderer's logger, but safe to call from the cooker worker threads
+class Logger
+{
+public:
+	enum Level
+	{
+		LEVEL_ERROR = 0,
+		LEVEL_WARNING,
+		LEVEL_INFO
+	};
+
+public:
+	static Logger& Get()
+	{
+		static Logger instance;
+		return instance;
+	}
+
+	void SetLevel(Level level)
+	{
+		m_LogLevel = level;
+	}
+
+	void Error(const std::string& message)
+	{
+		if (m_LogLevel >= LEVEL_ERROR)
+			Print("[ERROR] ", message);
+	}
+	void Warning(const std::string& message)
+	{
+		if (m_LogLevel >= LEVEL_WARNING)
+			Print("[WARNING] ", message);
+	}
+	void Info(const std::string& message)
+	{
+		if (m_LogLevel >= LEVEL_INFO)
+			Print("[INFO] ", message);
+	}
+
+private:
+	Level m_LogLevel;
+	std::mutex m_Mutex;
+
+private:
+	Logger() : m_LogLevel(LEVEL_ERROR) {}
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+	void Print(const char* prefix, const std::string& message)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::cout << prefix << message << std::endl;
+	}
+};
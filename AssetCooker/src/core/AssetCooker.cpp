@@ -0,0 +1,207 @@
+#include "AssetCooker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "common/Logger.hpp"
+#include "cookers/MeshCooker.h"
+#include "cookers/ShaderCooker.h"
+#include "cookers/TextureCooker.h"
+
+#define COOK_DATABASE_FILE "cook.db"
+
+namespace fs = std::filesystem;
+
+AssetCooker::AssetCooker(const fs::path& inputRoot, const fs::path& outputRoot, unsigned int threadCount, bool force) :
+	m_InputRoot(inputRoot), m_OutputRoot(outputRoot),
+	m_ThreadCount(threadCount), m_Force(force),
+	m_NextJob(0), m_Cooked(0), m_UpToDate(0), m_Failed(0)
+{
+	if (m_ThreadCount == 0)
+		m_ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+int AssetCooker::Run()
+{
+	auto start = std::chrono::steady_clock::now();
+	Logger& logger = Logger::Get();
+
+	if (!fs::is_directory(m_InputRoot))
+	{
+		logger.Error("Input directory does not exist: " + m_InputRoot.string());
+		return 1;
+	}
+
+	if (!m_Force)
+		m_Database.Load(m_OutputRoot / COOK_DATABASE_FILE);
+
+	Scan();
+	logger.Info("Found " + std::to_string(m_Jobs.size()) + " assets in " + m_InputRoot.string());
+
+	// Shaders go last in the list and are handled here, everything else goes to the workers
+	auto firstShader = std::stable_partition(m_Jobs.begin(), m_Jobs.end(),
+		[](const CookJob& job) { return job.type != AssetType::SHADER; });
+	size_t workerJobCount = firstShader - m_Jobs.begin();
+
+	std::vector<std::thread> workers;
+	unsigned int workerCount = static_cast<unsigned int>(std::min<size_t>(m_ThreadCount, workerJobCount));
+	for (unsigned int i = 0; i < workerCount; i++)
+		workers.emplace_back(&AssetCooker::WorkerLoop, this);
+
+	if (firstShader != m_Jobs.end())
+	{
+		bool hasContext = ShaderCooker::Init();
+		for (auto it = firstShader; it != m_Jobs.end(); ++it)
+			Process(*it);
+		if (hasContext)
+			ShaderCooker::Shutdown();
+	}
+
+	for (auto& worker : workers)
+		worker.join();
+
+	// Forget assets that were deleted from the input tree
+	std::vector<std::string> keys;
+	keys.reserve(m_Jobs.size());
+	for (const auto& job : m_Jobs)
+		keys.push_back(job.key);
+	m_Database.RemoveAllExcept(keys);
+	m_Database.Save(m_OutputRoot / COOK_DATABASE_FILE);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::stringstream ss;
+	ss << m_Cooked << " cooked, " << m_UpToDate << " up to date, " << m_Failed << " failed "
+	   << "(" << workerCount << " threads, " << seconds << "s)";
+	if (m_Failed > 0)
+		logger.Error(ss.str());
+	else
+		logger.Info(ss.str());
+
+	return m_Failed;
+}
+
+void AssetCooker::Scan()
+{
+	std::error_code ec;
+	for (fs::recursive_directory_iterator it(m_InputRoot, ec), end; it != end; it.increment(ec))
+	{
+		if (ec)
+		{
+			Logger::Get().Warning("Error while scanning " + m_InputRoot.string() + ": " + ec.message());
+			break;
+		}
+
+		if (!it->is_regular_file())
+			continue;
+
+		const fs::path& source = it->path();
+		fs::path relative = source.lexically_relative(m_InputRoot);
+
+		// Cooked files keep the source name and add their own extension, so
+		// wall.jpg and wall.png never end up in the same output file
+		CookJob job;
+		job.key = relative.generic_string();
+		job.source = source;
+		job.output = relative;
+
+		if (ShaderCooker::CanCook(source))
+		{
+			job.type = AssetType::SHADER;
+		}
+		else if (TextureCooker::CanCook(source))
+		{
+			job.type = AssetType::TEXTURE;
+			job.output += ".tex";
+		}
+		else if (MeshCooker::CanCook(source))
+		{
+			job.type = AssetType::MESH;
+			job.output += ".mesh";
+		}
+		else
+		{
+			continue;
+		}
+
+		m_Jobs.push_back(std::move(job));
+	}
+}
+
+void AssetCooker::WorkerLoop()
+{
+	size_t index;
+	while ((index = m_NextJob.fetch_add(1)) < m_Jobs.size())
+	{
+		// Shaders were partitioned at the end of the list
+		if (m_Jobs[index].type == AssetType::SHADER)
+			break;
+		Process(m_Jobs[index]);
+	}
+}
+
+void AssetCooker::Process(const CookJob& job)
+{
+	unsigned int version = GetCookerVersion(job.type);
+	AssetRecord refreshed;
+	if (!m_Force && m_Database.IsUpToDate(job.key, version, m_OutputRoot, &refreshed))
+	{
+		if (!refreshed.dependencies.empty())
+			m_Database.Update(job.key, std::move(refreshed));
+		m_UpToDate++;
+		return;
+	}
+
+	Logger::Get().Info("Cooking " + job.key);
+
+	std::vector<fs::path> dependencies;
+	fs::path output = m_OutputRoot / job.output;
+	bool success = false;
+
+	switch (job.type)
+	{
+		case AssetType::MESH:
+			success = MeshCooker::Cook(job.source, output, dependencies);
+			break;
+		case AssetType::TEXTURE:
+			success = TextureCooker::Cook(job.source, output, dependencies);
+			break;
+		case AssetType::SHADER:
+			success = ShaderCooker::Cook(job.source, output, dependencies);
+			break;
+	}
+
+	if (!success)
+	{
+		m_Database.Remove(job.key);
+		m_Failed++;
+		return;
+	}
+
+	AssetRecord record;
+	record.cookerVersion = version;
+	record.output = job.output.generic_string();
+	record.dependencies.reserve(dependencies.size());
+	for (const auto& dependency : dependencies)
+	{
+		DependencyRecord dep;
+		if (CookDatabase::Fingerprint(dependency, dep))
+			record.dependencies.push_back(std::move(dep));
+	}
+
+	m_Database.Update(job.key, std::move(record));
+	m_Cooked++;
+}
+
+unsigned int AssetCooker::GetCookerVersion(AssetType type)
+{
+	switch (type)
+	{
+		case AssetType::MESH: return MeshCooker::VERSION;
+		case AssetType::TEXTURE: return TextureCooker::VERSION;
+		case AssetType::SHADER: return ShaderCooker::VERSION;
+	}
+	return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "CookDatabase.h"
+
+enum class AssetType
+{
+	MESH = 0,
+	TEXTURE,
+	SHADER
+};
+
+struct CookJob
+{
+	AssetType type;
+	std::string key;					// path relative to the input root, used as database key
+	std::filesystem::path source;
+	std::filesystem::path output;		// relative to the output root
+};
+
+// Walks the input tree, figures out which assets changed since the last run and
+// cooks them on all cores. Shaders are validated on the calling thread in the
+// meantime because they need the GL context.
+class AssetCooker
+{
+public:
+	AssetCooker(const std::filesystem::path& inputRoot, const std::filesystem::path& outputRoot, unsigned int threadCount, bool force);
+
+	// Returns the number of assets that failed to cook
+	int Run();
+
+private:
+	std::filesystem::path m_InputRoot;
+	std::filesystem::path m_OutputRoot;
+	unsigned int m_ThreadCount;
+	bool m_Force;
+
+	CookDatabase m_Database;
+	std::vector<CookJob> m_Jobs;
+
+	std::atomic<size_t> m_NextJob;
+	std::atomic<int> m_Cooked;
+	std::atomic<int> m_UpToDate;
+	std::atomic<int> m_Failed;
+
+private:
+	void Scan();
+	void WorkerLoop();
+	void Process(const CookJob& job);
+
+	static unsigned int GetCookerVersion(AssetType type);
+};
@@ -0,0 +1,211 @@
+#include "CookDatabase.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "common/Hash.hpp"
+#include "common/Logger.hpp"
+
+#define COOK_DATABASE_HEADER "# AssetCooker database v1"
+
+namespace fs = std::filesystem;
+
+bool CookDatabase::Load(const fs::path& file)
+{
+	std::ifstream in(file);
+	if (!in)
+		return false;
+
+	std::string line;
+	if (!std::getline(in, line) || line != COOK_DATABASE_HEADER)
+	{
+		Logger::Get().Warning("Ignoring cook database with unknown format: " + file.string());
+		return false;
+	}
+
+	// Records are tab separated so paths can contain spaces:
+	//   asset <path> <cooker version> <output> <dependency count>
+	//   dep <path> <size> <write time> <hash>
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records.clear();
+
+	AssetRecord* current = nullptr;
+	while (std::getline(in, line))
+	{
+		std::vector<std::string> fields;
+		std::stringstream ss(line);
+		std::string field;
+		while (std::getline(ss, field, '\t'))
+			fields.push_back(field);
+
+		// A damaged database is dropped as a whole, every asset is cooked again and the next save rewrites it
+		try
+		{
+			if (fields.size() == 5 && fields[0] == "asset")
+			{
+				AssetRecord record;
+				record.cookerVersion = static_cast<uint32_t>(std::stoul(fields[2]));
+				record.output = fields[3];
+				record.dependencies.reserve(std::stoul(fields[4]));
+				current = &(m_Records[fields[1]] = std::move(record));
+			}
+			else if (fields.size() == 5 && fields[0] == "dep" && current)
+			{
+				DependencyRecord dep;
+				dep.path = fields[1];
+				dep.size = std::stoull(fields[2]);
+				dep.writeTime = std::stoll(fields[3]);
+				dep.hash = std::stoull(fields[4], nullptr, 16);
+				current->dependencies.push_back(std::move(dep));
+			}
+		}
+		catch (const std::exception&)
+		{
+			Logger::Get().Warning("Ignoring damaged cook database: " + file.string());
+			m_Records.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CookDatabase::Save(const fs::path& file) const
+{
+	// Written next to the real file and swapped in, an interrupted cook never leaves a truncated database
+	fs::path temp = file;
+	temp += ".tmp";
+
+	{
+		std::ofstream out(temp, std::ios::trunc);
+		if (!out)
+		{
+			Logger::Get().Error("Cannot write cook database: " + temp.string());
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		out << COOK_DATABASE_HEADER << '\n';
+		for (const auto& entry : m_Records)
+		{
+			const AssetRecord& record = entry.second;
+			out << "asset\t" << entry.first << '\t' << record.cookerVersion << '\t' << record.output << '\t' << record.dependencies.size() << '\n';
+			for (const auto& dep : record.dependencies)
+				out << "dep\t" << dep.path << '\t' << dep.size << '\t' << dep.writeTime << '\t' << std::hex << dep.hash << std::dec << '\n';
+		}
+	}
+
+	std::error_code ec;
+	fs::rename(temp, file, ec);
+	if (ec)
+	{
+		Logger::Get().Error("Cannot replace cook database: " + ec.message());
+		return false;
+	}
+
+	return true;
+}
+
+bool CookDatabase::IsUpToDate(const std::string& asset, uint32_t cookerVersion, const fs::path& outputRoot, AssetRecord* refreshed) const
+{
+	AssetRecord record;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = m_Records.find(asset);
+		if (it == m_Records.end())
+			return false;
+		record = it->second;
+	}
+
+	if (record.cookerVersion != cookerVersion || record.dependencies.empty())
+		return false;
+
+	std::error_code ec;
+	if (!fs::exists(outputRoot / record.output, ec))
+		return false;
+
+	bool isRefreshed = false;
+	for (auto& dep : record.dependencies)
+	{
+		uint64_t size = fs::file_size(dep.path, ec);
+		if (ec || size != dep.size)
+			return false;
+
+		int64_t writeTime = fs::last_write_time(dep.path, ec).time_since_epoch().count();
+		if (ec)
+			return false;
+		if (writeTime == dep.writeTime)
+			continue;
+
+		// Touched but maybe not modified
+		uint64_t hash;
+		if (!HashFile(dep.path, hash) || hash != dep.hash)
+			return false;
+		dep.writeTime = writeTime;
+		isRefreshed = true;
+	}
+
+	if (isRefreshed && refreshed)
+		*refreshed = std::move(record);
+	return true;
+}
+
+void CookDatabase::Update(const std::string& asset, AssetRecord&& record)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records[asset] = std::move(record);
+}
+
+void CookDatabase::Remove(const std::string& asset)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records.erase(asset);
+}
+
+void CookDatabase::RemoveAllExcept(const std::vector<std::string>& assets)
+{
+	std::unordered_set<std::string> keep(assets.begin(), assets.end());
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (auto it = m_Records.begin(); it != m_Records.end();)
+	{
+		if (keep.count(it->first) == 0)
+			it = m_Records.erase(it);
+		else
+			++it;
+	}
+}
+
+bool CookDatabase::Fingerprint(const fs::path& file, DependencyRecord& record)
+{
+	std::error_code ec;
+	record.path = file.string();
+	record.size = fs::file_size(file, ec);
+	if (ec)
+		return false;
+
+	record.writeTime = fs::last_write_time(file, ec).time_since_epoch().count();
+	if (ec)
+		return false;
+
+	return HashFile(file, record.hash);
+}
+
+bool CookDatabase::HashFile(const fs::path& file, uint64_t& hash)
+{
+	std::ifstream in(file, std::ios::binary);
+	if (!in)
+		return false;
+
+	char buffer[64 * 1024];
+	hash = Hash::SEED;
+	while (in)
+	{
+		in.read(buffer, sizeof(buffer));
+		hash = Hash::Fnv1a(buffer, static_cast<size_t>(in.gcount()), hash);
+	}
+
+	return true;
+}
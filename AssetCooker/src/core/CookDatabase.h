@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fingerprint of one file an asset was cooked from
+struct DependencyRecord
+{
+	std::string path;
+	uint64_t size;
+	int64_t writeTime;
+	uint64_t hash;
+};
+
+struct AssetRecord
+{
+	uint32_t cookerVersion;
+	std::string output;
+	std::vector<DependencyRecord> dependencies;
+};
+
+// Remembers what every asset was built from, so only changed assets are cooked again.
+// Dependencies are compared by size and write time first, the content hash is only
+// computed when those differ (e.g. after a fresh checkout).
+class CookDatabase
+{
+public:
+	bool Load(const std::filesystem::path& file);
+	bool Save(const std::filesystem::path& file) const;
+
+	// When only write times changed, refreshed receives the record with the new ones so the
+	// caller can Update it and the files are not hashed again next time. Left untouched otherwise.
+	bool IsUpToDate(const std::string& asset, uint32_t cookerVersion, const std::filesystem::path& outputRoot, AssetRecord* refreshed = nullptr) const;
+	void Update(const std::string& asset, AssetRecord&& record);
+	void Remove(const std::string& asset);
+	void RemoveAllExcept(const std::vector<std::string>& assets);
+
+	static bool Fingerprint(const std::filesystem::path& file, DependencyRecord& record);
+
+private:
+	std::unordered_map<std::string, AssetRecord> m_Records;
+	mutable std::mutex m_Mutex;
+
+private:
+	static bool HashFile(const std::filesystem::path& file, uint64_t& hash);
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+
+// Binary layouts written by the cooker. Everything is little endian and tightly packed,
+// so a runtime loader can read the header and hand the payload straight to OpenGL.
+
+#define COOKED_MESH_MAGIC 0x4853454Du	// "MESH"
+#define COOKED_TEXTURE_MAGIC 0x58455454u	// "TTEX"
+#define COOKED_MESH_VERSION 1
+#define COOKED_TEXTURE_VERSION 1
+
+#pragma pack(push, 1)
+
+// .mesh file:
+//   CookedMeshHeader
+//   CookedSubmesh[submeshCount]
+//   CookedVertex[vertexCount]
+//   index data (indexCount * indexSize bytes, indices are relative to the submesh baseVertex)
+//   CookedMaterial[materialCount]
+struct CookedMeshHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t submeshCount;
+	uint32_t materialCount;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexSize;			// 2 or 4 bytes
+	float aabbMin[3];
+	float aabbMax[3];
+};
+
+struct CookedSubmesh
+{
+	uint32_t baseVertex;
+	uint32_t vertexCount;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+};
+
+// Same layout as the renderer's Vertex struct
+struct CookedVertex
+{
+	float position[3];
+	float normal[3];
+	float texCoords[2];
+};
+
+// Texture paths are relative to the source model and point to the cooked .tex files
+struct CookedMaterial
+{
+	char diffuse[128];
+	char specular[128];
+	char emissive[128];
+};
+
+// .tex file:
+//   CookedTextureHeader
+//   mip level data, largest first, each level is width * height * channels bytes
+struct CookedTextureHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;			// 1, 2, 3 or 4 (unsigned bytes)
+	uint32_t mipCount;
+};
+
+#pragma pack(pop)
@@ -0,0 +1,215 @@
+#include "MeshCooker.h"
+
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <string>
+
+#include "common/BinaryWriter.hpp"
+#include "common/Logger.hpp"
+#include "core/CookedFormats.h"
+
+namespace fs = std::filesystem;
+
+// Records every file Assimp opens (.mtl libraries, .bin buffers, ...) so a change
+// in any of them triggers a rebuild of the model
+class DependencyTrackingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+	DependencyTrackingIOSystem(std::vector<fs::path>& dependencies) :
+		m_Dependencies(dependencies)
+	{
+	}
+
+	Assimp::IOStream* Open(const char* pFile, const char* pMode = "rb") override
+	{
+		Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(pFile, pMode);
+		if (stream)
+		{
+			fs::path path = fs::absolute(pFile).lexically_normal();
+			if (std::find(m_Dependencies.begin(), m_Dependencies.end(), path) == m_Dependencies.end())
+				m_Dependencies.push_back(path);
+		}
+		return stream;
+	}
+
+private:
+	std::vector<fs::path>& m_Dependencies;
+};
+
+static void CopyTexturePath(const aiMaterial* material, aiTextureType type, char (&dst)[128]);
+
+bool MeshCooker::CanCook(const fs::path& source)
+{
+	std::string extension = source.extension().string();
+	if (extension.empty())
+		return false;
+
+	Assimp::Importer importer;
+	return importer.IsExtensionSupported(extension);
+}
+
+bool MeshCooker::Cook(const fs::path& source, const fs::path& output, std::vector<fs::path>& dependencies)
+{
+	Assimp::Importer importer;
+	// Importer takes ownership of the IO handler
+	importer.SetIOHandler(new DependencyTrackingIOSystem(dependencies));
+
+	// Point and line primitives are split out by SortByPType and dropped below
+	importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+
+	const aiScene* scene = importer.ReadFile(source.string(),
+		aiProcess_Triangulate |
+		aiProcess_JoinIdenticalVertices |
+		aiProcess_GenSmoothNormals |
+		aiProcess_SortByPType |
+		aiProcess_FindDegenerates |
+		aiProcess_FindInvalidData |
+		aiProcess_RemoveRedundantMaterials |
+		aiProcess_OptimizeMeshes |
+		aiProcess_ImproveCacheLocality |
+		aiProcess_ValidateDataStructure);
+
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		Logger::Get().Error(source.string() + ": " + importer.GetErrorString());
+		return false;
+	}
+
+	std::vector<CookedSubmesh> submeshes;
+	std::vector<CookedVertex> vertices;
+	std::vector<unsigned int> indices;
+	submeshes.reserve(scene->mNumMeshes);
+
+	CookedMeshHeader header = {};
+	header.magic = COOKED_MESH_MAGIC;
+	header.version = COOKED_MESH_VERSION;
+	std::fill(std::begin(header.aabbMin), std::end(header.aabbMin), FLT_MAX);
+	std::fill(std::begin(header.aabbMax), std::end(header.aabbMax), -FLT_MAX);
+
+	unsigned int maxSubmeshVertices = 0;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+	{
+		const aiMesh* mesh = scene->mMeshes[m];
+		if (!(mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) || mesh->mNumFaces == 0)
+			continue;
+
+		CookedSubmesh submesh;
+		submesh.baseVertex = static_cast<uint32_t>(vertices.size());
+		submesh.vertexCount = mesh->mNumVertices;
+		submesh.firstIndex = static_cast<uint32_t>(indices.size());
+		submesh.indexCount = mesh->mNumFaces * 3;
+		submesh.materialIndex = mesh->mMaterialIndex;
+		maxSubmeshVertices = std::max(maxSubmeshVertices, mesh->mNumVertices);
+
+		vertices.resize(vertices.size() + mesh->mNumVertices);
+		CookedVertex* dst = vertices.data() + submesh.baseVertex;
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+		{
+			const aiVector3D& p = mesh->mVertices[i];
+			dst[i].position[0] = p.x;
+			dst[i].position[1] = p.y;
+			dst[i].position[2] = p.z;
+
+			header.aabbMin[0] = std::min(header.aabbMin[0], p.x);
+			header.aabbMin[1] = std::min(header.aabbMin[1], p.y);
+			header.aabbMin[2] = std::min(header.aabbMin[2], p.z);
+			header.aabbMax[0] = std::max(header.aabbMax[0], p.x);
+			header.aabbMax[1] = std::max(header.aabbMax[1], p.y);
+			header.aabbMax[2] = std::max(header.aabbMax[2], p.z);
+
+			const aiVector3D n = mesh->HasNormals() ? mesh->mNormals[i] : aiVector3D(0.0f, 1.0f, 0.0f);
+			dst[i].normal[0] = n.x;
+			dst[i].normal[1] = n.y;
+			dst[i].normal[2] = n.z;
+
+			const aiVector3D uv = mesh->HasTextureCoords(0) ? mesh->mTextureCoords[0][i] : aiVector3D(0.0f);
+			dst[i].texCoords[0] = uv.x;
+			dst[i].texCoords[1] = uv.y;
+		}
+
+		// Indices stay relative to the submesh, they are drawn with a base vertex
+		indices.resize(indices.size() + submesh.indexCount);
+		unsigned int* idx = indices.data() + submesh.firstIndex;
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+		{
+			const aiFace& face = mesh->mFaces[f];
+			idx[f * 3 + 0] = face.mIndices[0];
+			idx[f * 3 + 1] = face.mIndices[1];
+			idx[f * 3 + 2] = face.mIndices[2];
+		}
+
+		submeshes.push_back(submesh);
+	}
+
+	if (submeshes.empty())
+	{
+		Logger::Get().Error(source.string() + ": no triangle meshes found");
+		return false;
+	}
+
+	header.submeshCount = static_cast<uint32_t>(submeshes.size());
+	header.materialCount = scene->mNumMaterials;
+	header.vertexCount = static_cast<uint32_t>(vertices.size());
+	header.indexCount = static_cast<uint32_t>(indices.size());
+	header.indexSize = maxSubmeshVertices <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+	BinaryWriter writer;
+	writer.Reserve(sizeof(header) + submeshes.size() * sizeof(CookedSubmesh) + vertices.size() * sizeof(CookedVertex) +
+		indices.size() * header.indexSize + scene->mNumMaterials * sizeof(CookedMaterial));
+
+	writer.Write(header);
+	writer.WriteArray(submeshes);
+	writer.WriteArray(vertices);
+
+	if (header.indexSize == sizeof(uint16_t))
+	{
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		writer.WriteArray(shortIndices);
+	}
+	else
+	{
+		writer.WriteArray(indices);
+	}
+
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+	{
+		CookedMaterial material = {};
+		CopyTexturePath(scene->mMaterials[i], aiTextureType_DIFFUSE, material.diffuse);
+		CopyTexturePath(scene->mMaterials[i], aiTextureType_SPECULAR, material.specular);
+		CopyTexturePath(scene->mMaterials[i], aiTextureType_EMISSIVE, material.emissive);
+		writer.Write(material);
+	}
+
+	if (!writer.SaveTo(output))
+	{
+		Logger::Get().Error("Cannot write " + output.string());
+		return false;
+	}
+
+	return true;
+}
+
+static void CopyTexturePath(const aiMaterial* material, aiTextureType type, char (&dst)[128])
+{
+	if (material->GetTextureCount(type) == 0)
+		return;
+
+	aiString path;
+	material->GetTexture(type, 0, &path);
+
+	// Points to the cooked texture, which keeps the source name plus the .tex extension
+	std::string cooked = std::string(path.C_Str()) + ".tex";
+	if (cooked.size() >= sizeof(dst))
+	{
+		Logger::Get().Warning("Texture path too long, dropped: " + cooked);
+		return;
+	}
+
+	std::memcpy(dst, cooked.c_str(), cooked.size() + 1);
+}
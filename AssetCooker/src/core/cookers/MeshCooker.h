@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+// Imports any format Assimp understands and writes a .mesh file (see CookedFormats.h)
+// with welded, cache-optimized triangles ready to be uploaded as-is.
+class MeshCooker
+{
+public:
+	static constexpr unsigned int VERSION = 1;
+
+	static bool CanCook(const std::filesystem::path& source);
+	static bool Cook(const std::filesystem::path& source, const std::filesystem::path& output, std::vector<std::filesystem::path>& dependencies);
+};
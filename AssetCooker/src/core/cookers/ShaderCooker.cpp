@@ -0,0 +1,147 @@
+#include "ShaderCooker.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "common/BinaryWriter.hpp"
+#include "common/Logger.hpp"
+
+// Shared with the Lighting renderer, the feature defines its Shader adds at load time
+#include "ShaderFeatures.h"
+
+namespace fs = std::filesystem;
+
+GLFWwindow* ShaderCooker::s_Context = nullptr;
+
+static GLenum GetShaderStage(const fs::path& source);
+static bool Compile(GLenum stage, const std::string& code, std::string& infoLog);
+
+bool ShaderCooker::Init()
+{
+	if (!glfwInit())
+	{
+		Logger::Get().Error("Failed to initialize GLFW, shaders cannot be validated");
+		return false;
+	}
+
+	// Same context the renderers ask for, so validation matches what they will see
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	s_Context = glfwCreateWindow(1, 1, "AssetCooker", NULL, NULL);
+	if (!s_Context)
+	{
+		Logger::Get().Error("Failed to create a GL 4.6 context, shaders cannot be validated");
+		glfwTerminate();
+		return false;
+	}
+
+	glfwMakeContextCurrent(s_Context);
+	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+	{
+		Logger::Get().Error("Failed to initialize GLAD");
+		Shutdown();
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderCooker::Shutdown()
+{
+	if (s_Context)
+		glfwDestroyWindow(s_Context);
+	s_Context = nullptr;
+	glfwTerminate();
+}
+
+bool ShaderCooker::CanCook(const fs::path& source)
+{
+	return GetShaderStage(source) != GL_NONE;
+}
+
+bool ShaderCooker::Cook(const fs::path& source, const fs::path& output, std::vector<fs::path>& dependencies)
+{
+	dependencies.push_back(fs::absolute(source).lexically_normal());
+
+	if (!s_Context)
+	{
+		Logger::Get().Error(source.string() + ": no GL context to validate against");
+		return false;
+	}
+
+	std::ifstream file(source, std::ios::binary);
+	if (!file)
+	{
+		Logger::Get().Error("Cannot read " + source.string());
+		return false;
+	}
+
+	std::stringstream ss;
+	ss << file.rdbuf();
+	std::string code = ss.str();
+
+	// Validated the way the renderer compiles it, with the feature defines: the variant
+	// without features and the one with every feature the source tests. The cooked file
+	// stays the raw source, the defines are added at load time.
+	unsigned int supported = FindShaderFeatures(code);
+	unsigned int variants[2] = { 0, supported };
+	for (unsigned int i = 0; i < (supported != 0 ? 2u : 1u); i++)
+	{
+		std::string infoLog;
+		if (!Compile(GetShaderStage(source), AddShaderDefines(code, variants[i]), infoLog))
+		{
+			Logger::Get().Error(source.string() + " failed to compile (feature bits " + std::to_string(variants[i]) + "):\n" + infoLog);
+			return false;
+		}
+	}
+
+	BinaryWriter writer;
+	writer.WriteBytes(code.data(), code.size());
+	if (!writer.SaveTo(output))
+	{
+		Logger::Get().Error("Cannot write " + output.string());
+		return false;
+	}
+
+	return true;
+}
+
+static bool Compile(GLenum stage, const std::string& code, std::string& infoLog)
+{
+	const char* codePtr = code.c_str();
+	unsigned int shader = glCreateShader(stage);
+	glShaderSource(shader, 1, &codePtr, NULL);
+	glCompileShader(shader);
+
+	int success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		int length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		infoLog.assign(length > 0 ? length : 1, '\0');
+		glGetShaderInfoLog(shader, static_cast<GLsizei>(infoLog.size()), NULL, &infoLog[0]);
+	}
+	glDeleteShader(shader);
+	return success != 0;
+}
+
+static GLenum GetShaderStage(const fs::path& source)
+{
+	std::string extension = source.extension().string();
+
+	if (extension == ".vert") return GL_VERTEX_SHADER;
+	if (extension == ".frag") return GL_FRAGMENT_SHADER;
+	if (extension == ".geom") return GL_GEOMETRY_SHADER;
+	if (extension == ".tesc") return GL_TESS_CONTROL_SHADER;
+	if (extension == ".tese") return GL_TESS_EVALUATION_SHADER;
+	if (extension == ".comp") return GL_COMPUTE_SHADER;
+	return GL_NONE;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+struct GLFWwindow;
+
+// Compiles every shader stage against a hidden GL 4.6 context, with the feature defines
+// of ShaderFeatures.h, and only copies it to the output tree when it compiles. Needs the GL context, so it must run on the main thread.
+class ShaderCooker
+{
+public:
+	static constexpr unsigned int VERSION = 2;
+
+	static bool Init();
+	static void Shutdown();
+
+	static bool CanCook(const std::filesystem::path& source);
+	static bool Cook(const std::filesystem::path& source, const std::filesystem::path& output, std::vector<std::filesystem::path>& dependencies);
+
+private:
+	static GLFWwindow* s_Context;
+};
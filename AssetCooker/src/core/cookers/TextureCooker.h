@@ -0,0 +1,15 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+// Decodes PNG/JPG/TGA/BMP images and writes a .tex file (see CookedFormats.h)
+// containing the full, pre-filtered mip chain.
+class TextureCooker
+{
+public:
+	static constexpr unsigned int VERSION = 1;
+
+	static bool CanCook(const std::filesystem::path& source);
+	static bool Cook(const std::filesystem::path& source, const std::filesystem::path& output, std::vector<std::filesystem::path>& dependencies);
+};
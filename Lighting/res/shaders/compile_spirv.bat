@@ -0,0 +1,16 @@
+@echo off
+rem Compiles the GLSL shaders to SPIR-V for the OpenGL 4.6 path of Shader.
+rem Needs glslangValidator on the PATH, it comes with the Vulkan SDK.
+rem The feature switches stay specialization constants, one module per stage
+rem covers every variant. Run again after editing a shader, Shader loads
+rem spirv\<file>.spv whenever it exists and the GLSL only otherwise.
+rem Uniforms are still set by name, so the debug names are kept.
+
+setlocal
+cd /d "%~dp0"
+if not exist spirv mkdir spirv
+
+for %%f in (default.vert default.frag gouraud.vert gouraud.frag flat.vert flat.frag gooch.frag point_light.frag) do (
+	glslangValidator -G --auto-map-locations -o spirv\%%f.spv %%f
+	if errorlevel 1 exit /b 1
+)
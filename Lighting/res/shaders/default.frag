@@ -1,23 +1,28 @@
 #version 460 core
 
-#define MAX_POINT_LIGHTS 128
-
-in vec3 Normal;
-in vec2 TexCoord;
-in vec3 FragPosition;
+layout (location = 0) in vec3 Normal;
+layout (location = 1) in vec3 FragPosition;
+layout (location = 2) in vec2 TexCoord;
+layout (location = 3) flat in uint DrawIndex;
 
 out vec4 FragColor;
 
+// Added as defines to the GLSL, specialization constants in the SPIR-V, see Shader.h
+#ifdef GL_SPIRV
+layout (constant_id = 0) const bool FEATURE_TEXTURED = false;
+layout (constant_id = 1) const bool FEATURE_FLASHLIGHT = false;
+layout (constant_id = 2) const bool FEATURE_EMISSION = false;
+layout (constant_id = 3) const bool FEATURE_POINT_LIGHTS = false;
+layout (constant_id = 4) const uint MAX_POINT_LIGHTS = 128u;
+#endif
+
 struct Material
 {
 	vec3 ambient;
 	vec3 diffuse;
 	vec3 specular;
 	float shininess;
-
-	sampler2D diffuseMap;
-	sampler2D specularMap;
-	sampler2D emissionMap;
+	vec3 layers;		// diffuse, specular and emission
 };
 
 struct DirLight
@@ -50,15 +55,62 @@ struct SpotLight
 	vec3 specular;
 };
 
-uniform Material u_material;
+struct DrawData
+{
+	uint transformIndex;
+	uint materialIndex;
+	uint lightOffset;
+	uint lightCount;
+	vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData u_draws[];
+};
+
+// Material colors, specular.w is the shininess and layers.xyz the diffuse, specular
+// and emission layers in the bound texture arrays
+struct MaterialData
+{
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+	vec4 layers;
+};
+
+layout (std430, binding = 2) readonly buffer Materials
+{
+	MaterialData u_materials[];
+};
+
+// View space position, position.w is the radius
+struct PointLightData
+{
+	vec4 position;
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+};
+
+layout (std430, binding = 3) readonly buffer PointLights
+{
+	PointLightData u_pointLights[];
+};
+
+// Lights reaching each draw, from lightOffset to lightOffset + lightCount
+layout (std430, binding = 4) readonly buffer LightIndices
+{
+	uint u_lightIndices[];
+};
+
 uniform DirLight u_dirLight;
 uniform SpotLight u_spotLight;
 
-uniform int u_pointLightsCount;
-uniform PointLight u_pointLights[MAX_POINT_LIGHTS];
-
-uniform bool u_isTextured;
-uniform bool u_isFlashlightOn;
+// Texture units, see Scene::BindGroupTextures
+layout (binding = 0) uniform sampler2DArray u_diffuseMap;
+layout (binding = 1) uniform sampler2DArray u_specularMap;
+layout (binding = 2) uniform sampler2DArray u_emissionMap;
 
 vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir);
@@ -73,19 +125,28 @@ void main()
 	vec3 norm = normalize(Normal);
 	vec3 viewDir = normalize(vec3(0.0) - FragPosition);
 
+	DrawData draw = u_draws[DrawIndex];
+	MaterialData m = u_materials[draw.materialIndex];
+	Material material = Material(m.ambient.xyz, m.diffuse.xyz, m.specular.xyz, m.specular.w, m.layers.xyz);
+
 	// Directional light
-	result += CalcDirLight(u_dirLight, u_material, norm, viewDir);
+	result += CalcDirLight(u_dirLight, material, norm, viewDir);
 
 	// Point lights
-	for(int i = 0; i < u_pointLightsCount; i++)
-      result += CalcPointLight(u_pointLights[i], u_material, norm, viewDir);
+	uint lightCount = FEATURE_POINT_LIGHTS ? min(draw.lightCount, MAX_POINT_LIGHTS) : 0u;
+	for(uint i = 0; i < lightCount; i++)
+	{
+		PointLightData l = u_pointLights[u_lightIndices[draw.lightOffset + i]];
+		PointLight light = PointLight(l.position.xyz, l.position.w, l.ambient.xyz, l.diffuse.xyz, l.specular.xyz);
+		result += CalcPointLight(light, material, norm, viewDir);
+	}
 
 	// Spot light / flash light
-	if(u_isFlashlightOn)
-		result += CalcSpotLight(u_spotLight, u_material, norm, viewDir);
+	if(FEATURE_FLASHLIGHT)
+		result += CalcSpotLight(u_spotLight, material, norm, viewDir);
 
-	if(u_isTextured)
-	  result += vec3(texture(u_material.emissionMap, TexCoord));
+	if(FEATURE_EMISSION)
+		result += vec3(texture(u_emissionMap, vec3(TexCoord, material.layers.z)));
 
 	FragColor = vec4(result, 1.0);
 }
@@ -95,20 +156,20 @@ vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir)
 	vec3 lightDir = normalize(-dir.direction);
 	vec3 ambient, diffuse, specular;
 
-	if(u_isTextured)
+	if(FEATURE_TEXTURED)
 	{
 		// Ambient
-		ambient = dir.ambient * vec3(texture(u_material.diffuseMap, TexCoord));
+		ambient = dir.ambient * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Diffuse
 		float diff = max(dot(normal, vec3(lightDir)), 0.0);
-		diffuse = dir.diffuse * diff * vec3(texture(u_material.diffuseMap, TexCoord));
+		diffuse = dir.diffuse * diff * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Specular
 		vec3 reflectDir = reflect(vec3(-lightDir), normal);
-		float spec = pow(max(dot(viewDir, reflectDir), 0.0), u_material.shininess);
-		specular = dir.specular * spec * vec3(texture(u_material.specularMap, TexCoord));
-	} 
+		float spec = pow(max(dot(viewDir, reflectDir), 0.0), mat.shininess);
+		specular = dir.specular * spec * vec3(texture(u_specularMap, vec3(TexCoord, mat.layers.y)));
+	}
 	else
 	{
 		// Ambient
@@ -134,20 +195,20 @@ vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir)
 	float distance = length(light.position - FragPosition);
 	float attenuation = Attenuate(distance, light.radius);
 
-	if(u_isTextured)
+	if(FEATURE_TEXTURED)
 	{
 		// Ambient
-		ambient = light.ambient * vec3(texture(u_material.diffuseMap, TexCoord));
+		ambient = light.ambient * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Diffuse
 		float diff = max(dot(normal, vec3(lightDir)), 0.0);
-		diffuse = light.diffuse * diff * vec3(texture(u_material.diffuseMap, TexCoord));
+		diffuse = light.diffuse * diff * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Specular
 		vec3 reflectDir = reflect(vec3(-lightDir), normal);
-		float spec = pow(max(dot(viewDir, reflectDir), 0.0), u_material.shininess);
-		specular = light.specular * spec * vec3(texture(u_material.specularMap, TexCoord));
-	} 
+		float spec = pow(max(dot(viewDir, reflectDir), 0.0), mat.shininess);
+		specular = light.specular * spec * vec3(texture(u_specularMap, vec3(TexCoord, mat.layers.y)));
+	}
 	else
 	{
 		// Ambient
@@ -178,20 +239,20 @@ vec3 CalcSpotLight(SpotLight light, Material mat, vec3 normal, vec3 viewDir)
 	float epsilon = light.cutOff - light.outerCutOff;
 	float intensity = smoothstep(0.0, 1.0, (theta - light.outerCutOff) / epsilon);  
 
-	if(u_isTextured)
+	if(FEATURE_TEXTURED)
 	{
 		// Ambient
-		ambient = light.ambient * vec3(texture(u_material.diffuseMap, TexCoord));
+		ambient = light.ambient * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Diffuse
 		float diff = max(dot(normal, vec3(lightDir)), 0.0);
-		diffuse = light.diffuse * diff * vec3(texture(u_material.diffuseMap, TexCoord));
+		diffuse = light.diffuse * diff * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Specular
 		vec3 reflectDir = reflect(vec3(-lightDir), normal);
-		float spec = pow(max(dot(viewDir, reflectDir), 0.0), u_material.shininess);
-		specular = light.specular * spec * vec3(texture(u_material.specularMap, TexCoord));
-	} 
+		float spec = pow(max(dot(viewDir, reflectDir), 0.0), mat.shininess);
+		specular = light.specular * spec * vec3(texture(u_specularMap, vec3(TexCoord, mat.layers.y)));
+	}
 	else
 	{
 		// Ambient
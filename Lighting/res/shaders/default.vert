@@ -4,19 +4,48 @@ layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
 layout (location = 2) in vec2 vTexCoord;
 
-out vec3 Normal;
-out vec3 FragPosition;
-out vec2 TexCoord;
+layout (location = 0) out vec3 Normal;
+layout (location = 1) out vec3 FragPosition;
+layout (location = 2) out vec2 TexCoord;
+layout (location = 3) flat out uint DrawIndex;
+
+struct ObjectTransform
+{
+	mat4 world;
+	mat4 mvp;
+	vec4 normal[3];		// view space normal matrix columns
+};
+
+layout (std430, binding = 0) readonly buffer ObjectTransforms
+{
+	ObjectTransform u_objects[];
+};
+
+struct DrawData
+{
+	uint transformIndex;
+	uint materialIndex;
+	uint lightOffset;
+	uint lightCount;
+	vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData u_draws[];
+};
 
-uniform mat4 u_model;
 uniform mat4 u_view;
-uniform mat4 u_projection;
 
 void main()
 {
-	gl_Position = u_projection * u_view * u_model * vec4(vPosition, 1.0);
+	// Every multi-draw command carries its draw index as base instance
+	DrawIndex = uint(gl_BaseInstance);
+	ObjectTransform object = u_objects[u_draws[DrawIndex].transformIndex];
+
+	gl_Position = object.mvp * vec4(vPosition, 1.0);
 	
-	Normal = mat3(transpose(inverse(u_view * u_model))) * vNormal;
-	FragPosition = vec3(u_view * u_model * vec4(vPosition, 1.0));
+	Normal = mat3(object.normal[0].xyz, object.normal[1].xyz, object.normal[2].xyz) * vNormal;
+	FragPosition = vec3(u_view * object.world * vec4(vPosition, 1.0));
 	TexCoord = vTexCoord;
 };
\ No newline at end of file
@@ -1,21 +1,25 @@
 #version 460 core
 
-in vec3 Normal;
-in vec2 TexCoord;
-in vec3 FragPosition;
+layout (location = 0) in vec3 Normal;
+layout (location = 1) in vec3 FragPosition;
+layout (location = 2) in vec2 TexCoord;
+layout (location = 3) flat in uint DrawIndex;
 
 out vec4 FragColor;
 
+// Added as defines to the GLSL, specialization constants in the SPIR-V, see Shader.h
+#ifdef GL_SPIRV
+layout (constant_id = 0) const bool FEATURE_TEXTURED = false;
+layout (constant_id = 2) const bool FEATURE_EMISSION = false;
+#endif
+
 struct Material
 {
 	vec3 ambient;
 	vec3 diffuse;
 	vec3 specular;
 	float shininess;
-
-	sampler2D diffuseMap;
-	sampler2D specularMap;
-	sampler2D emissionMap;
+	vec3 layers;		// diffuse, specular and emission
 };
 
 struct DirLight
@@ -26,9 +30,41 @@ struct DirLight
 	vec3 specular;
 };
 
-uniform Material u_material;
+struct DrawData
+{
+	uint transformIndex;
+	uint materialIndex;
+	uint lightOffset;
+	uint lightCount;
+	vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData u_draws[];
+};
+
+// Material colors, specular.w is the shininess and layers.xyz the diffuse, specular
+// and emission layers in the bound texture arrays
+struct MaterialData
+{
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+	vec4 layers;
+};
+
+layout (std430, binding = 2) readonly buffer Materials
+{
+	MaterialData u_materials[];
+};
+
 uniform DirLight u_dirLight;
-uniform bool u_isTextured;
+
+// Texture units, see Scene::BindGroupTextures
+layout (binding = 0) uniform sampler2DArray u_diffuseMap;
+layout (binding = 1) uniform sampler2DArray u_specularMap;
+layout (binding = 2) uniform sampler2DArray u_emissionMap;
 
 vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir);
 
@@ -39,13 +75,16 @@ void main()
 	vec3 norm = normalize(Normal);
 	vec3 viewDir = normalize(vec3(0.0) - FragPosition);
 
-	result += CalcDirLight(u_dirLight, u_material, norm, viewDir);
+	MaterialData m = u_materials[u_draws[DrawIndex].materialIndex];
+	Material material = Material(m.ambient.xyz, m.diffuse.xyz, m.specular.xyz, m.specular.w, m.layers.xyz);
+
+	result += CalcDirLight(u_dirLight, material, norm, viewDir);
 
 	// @todo Point lights
 	// @todo Spot lights
 
-	if(u_isTextured)
-		result += vec3(texture(u_material.emissionMap, TexCoord));
+	if(FEATURE_EMISSION)
+		result += vec3(texture(u_emissionMap, vec3(TexCoord, material.layers.z)));
 
 	FragColor = vec4(result, 1.0);
 }
@@ -55,33 +94,33 @@ vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir)
 	vec3 lightDir = normalize(-dir.direction);
 	vec3 ambient, diffuse, specular;
 
-	if(u_isTextured)
+	if(FEATURE_TEXTURED)
 	{
 		// Ambient
-		ambient = dir.ambient * vec3(texture(u_material.diffuseMap, TexCoord));
+		ambient = dir.ambient * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Diffuse
 		float diff = max(dot(normal, vec3(lightDir)), 0.0);
-		diffuse = dir.diffuse * diff * vec3(texture(u_material.diffuseMap, TexCoord));
+		diffuse = dir.diffuse * diff * vec3(texture(u_diffuseMap, vec3(TexCoord, mat.layers.x)));
 
 		// Specular
 		vec3 reflectDir = reflect(vec3(-lightDir), normal);
-		float spec = pow(max(dot(viewDir, reflectDir), 0.0), u_material.shininess);
-		specular = dir.specular * spec * vec3(texture(u_material.specularMap, TexCoord));
-	} 
+		float spec = pow(max(dot(viewDir, reflectDir), 0.0), mat.shininess);
+		specular = dir.specular * spec * vec3(texture(u_specularMap, vec3(TexCoord, mat.layers.y)));
+	}
 	else
 	{
 		vec3 baseColor = mat.diffuse;
-	
+
 		vec3 cold = vec3(0, 0, 0.55) + baseColor;
 		vec3 warm = vec3(0.3, 0.3, 0) + baseColor;
 		vec3 highlight = dir.specular;
 
 		float t = (dot(normal, lightDir) + 1) / 2;
 		float t1 = max(dot(normal, lightDir), 0);
-	
+
 		vec3 color = mix(cold, warm, t);
-	
+
 		vec3 r = reflect(-lightDir, normal);
 		float s = clamp((100 * dot(r, viewDir) - 97), 0.0, 1.0);
 		vec3 result = mix(color, highlight, s);
@@ -1,11 +1,15 @@
 #version 460 core
 
-#define MAX_POINT_LIGHTS 128
-
 layout (location = 0) in vec3 vPosition;
 layout (location = 1) in vec3 vNormal;
 
-out vec3 Color;
+layout (location = 0) out vec3 Color;
+
+// Added as defines to the GLSL, specialization constants in the SPIR-V, see Shader.h
+#ifdef GL_SPIRV
+layout (constant_id = 3) const bool FEATURE_POINT_LIGHTS = false;
+layout (constant_id = 4) const uint MAX_POINT_LIGHTS = 128u;
+#endif
 
 struct Material
 {
@@ -33,36 +37,102 @@ struct PointLight
 	vec3 specular;
 };
 
-uniform Material u_material;
 uniform DirLight u_dirLight;
 
-uniform int u_pointLightsCount;
-uniform PointLight u_pointLights[MAX_POINT_LIGHTS];
+// Material colors, specular.w is the shininess and layers.xyz the diffuse, specular
+// and emission layers in the bound texture arrays
+struct MaterialData
+{
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+	vec4 layers;
+};
+
+layout (std430, binding = 2) readonly buffer Materials
+{
+	MaterialData u_materials[];
+};
+
+// View space position, position.w is the radius
+struct PointLightData
+{
+	vec4 position;
+	vec4 ambient;
+	vec4 diffuse;
+	vec4 specular;
+};
+
+layout (std430, binding = 3) readonly buffer PointLights
+{
+	PointLightData u_pointLights[];
+};
+
+// Lights reaching each draw, from lightOffset to lightOffset + lightCount
+layout (std430, binding = 4) readonly buffer LightIndices
+{
+	uint u_lightIndices[];
+};
+
+struct ObjectTransform
+{
+	mat4 world;
+	mat4 mvp;
+	vec4 normal[3];		// view space normal matrix columns
+};
+
+layout (std430, binding = 0) readonly buffer ObjectTransforms
+{
+	ObjectTransform u_objects[];
+};
+
+struct DrawData
+{
+	uint transformIndex;
+	uint materialIndex;
+	uint lightOffset;
+	uint lightCount;
+	vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData u_draws[];
+};
 
-uniform mat4 u_model;
 uniform mat4 u_view;
-uniform mat4 u_projection;
 
 vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir, vec3 vertPosition);
 
 float Attenuate(float dist, float radius);
 
 void main()
 {
 	// Compute vertex position
-	gl_Position = u_projection * u_view * u_model * vec4(vPosition, 1.0);
+	// Every multi-draw command carries its draw index as base instance
+	DrawData draw = u_draws[gl_BaseInstance];
+	ObjectTransform object = u_objects[draw.transformIndex];
+	gl_Position = object.mvp * vec4(vPosition, 1.0);
 
 	// Gouraud shader
 	vec3 result = vec3(0.0);
-	vec3 norm = mat3(transpose(inverse(u_view * u_model))) * vNormal;
-	vec3 vertPosition = vec3(u_view * u_model * vec4(vPosition, 1.0));
+	vec3 norm = mat3(object.normal[0].xyz, object.normal[1].xyz, object.normal[2].xyz) * vNormal;
+	vec3 vertPosition = vec3(u_view * object.world * vec4(vPosition, 1.0));
 	vec3 viewDir = normalize(vec3(0.0) - vertPosition);
 
-	result += CalcDirLight(u_dirLight, u_material, norm, viewDir);
+	MaterialData m = u_materials[draw.materialIndex];
+	Material material = Material(m.ambient.xyz, m.diffuse.xyz, m.specular.xyz, m.specular.w);
+
+	result += CalcDirLight(u_dirLight, material, norm, viewDir);
 
-	for(int i = 0; i < u_pointLightsCount; i++)
-      result += CalcPointLight(u_pointLights[i], u_material, norm, viewDir);
+	uint lightCount = FEATURE_POINT_LIGHTS ? min(draw.lightCount, MAX_POINT_LIGHTS) : 0u;
+	for(uint i = 0; i < lightCount; i++)
+	{
+		PointLightData l = u_pointLights[u_lightIndices[draw.lightOffset + i]];
+		PointLight light = PointLight(l.position.xyz, l.position.w, l.ambient.xyz, l.diffuse.xyz, l.specular.xyz);
+		result += CalcPointLight(light, material, norm, viewDir, vertPosition);
+	}
 
 	// @todo Spot lights
 	Color = result;
@@ -87,9 +157,9 @@ vec3 CalcDirLight(DirLight dir, Material mat, vec3 normal, vec3 viewDir)
 	return ambient + diffuse;
 }
 
-vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, Material mat, vec3 normal, vec3 viewDir, vec3 vertPosition)
 {
-	vec3 distanceVec = vec3(vec4(light.position, 1.0) - (u_view * u_model * vec4(vPosition, 1.0)));
+	vec3 distanceVec = light.position - vertPosition;
 	vec3 lightDir = normalize(distanceVec);
 	vec3 ambient, diffuse, specular;
 	float distance = length(distanceVec);
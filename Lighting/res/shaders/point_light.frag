@@ -1,14 +1,27 @@
 #version 460 core
 
-in vec3 Normal;
-in vec2 TexCoord;
-in vec3 FragPosition;
+layout (location = 0) in vec3 Normal;
+layout (location = 1) in vec3 FragPosition;
+layout (location = 2) in vec2 TexCoord;
+layout (location = 3) flat in uint DrawIndex;
 
 out vec4 FragColor;
 
-uniform vec3 u_Color;
+struct DrawData
+{
+	uint transformIndex;
+	uint materialIndex;
+	uint lightOffset;
+	uint lightCount;
+	vec4 color;
+};
+
+layout (std430, binding = 1) readonly buffer Draws
+{
+	DrawData u_draws[];
+};
 
 void main()
 {
-	FragColor = vec4(u_Color, 1.0);
+	FragColor = vec4(u_draws[DrawIndex].color.rgb, 1.0);
 };
\ No newline at end of file
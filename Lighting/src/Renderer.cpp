@@ -9,11 +9,15 @@
 #include <memory>
 
 #include "core/timer/Timer.h"
-#include "core/Object.h"
 #include "core/Camera.h"
 #include "core/Scene.h"
 #include "vendor/cubesphere/Cubesphere.h"
 #include "core/imgui/ImGuiWindow.h"
+#include "core/resource/GpuDeletionQueue.h"
+#include "core/resource/ProgramCache.h"
+#include "core/ShaderManager.h"
+#include "core/jobs/JobSystem.h"
+#include "core/transform/BatchTransform.h"
 
 #include "core/light/DirectionalLight.hpp"
 
@@ -24,6 +28,14 @@
 #define WINDOW_WIDTH 1280
 #define WINDOW_HEIGHT 720
 
+// Frames still drawn after the last change: the simulation builds one frame ahead
+// and ImGui needs one more to settle
+#define REDRAW_FRAMES 3
+// Longest wait for events while idle, background work is still polled at this rate
+#define IDLE_WAIT_SECONDS 0.5
+// Frame rate cap of an unfocused window
+#define UNFOCUSED_FRAME_RATE 10.0
+
 // @todo Move them in a common folder/file
 #define LOG(x) std::cout << x << std::endl
 #define LOG_GLM(x) LOG(glm::to_string(x).c_str())
@@ -32,6 +44,13 @@
 ImGuiWindow imGui;
 GLFWwindow* window;
 bool isFullscreen = false;
+bool isWindowFocused = true;
+
+// Event-driven rendering: frames are only drawn after input, an edit or while
+// something is still changing
+bool isEventDriven = true;
+int redrawFrames = REDRAW_FRAMES;
+double lastDrawTime = 0.0;
 
 // Renderer
 Timer& timer = Timer::Get();
@@ -52,12 +71,18 @@ static void ProcessCameraInput();
 static void ClearBuffers();
 static void CheckOpenGLErrors();
 static void SceneSetup();
+static void RequestRedraw();
+static void WaitForEvents();
+static bool ShouldDraw();
 
 static void OnResize(GLFWwindow* window, int width, int height);
 static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, int mods);
 static void OnMouse(GLFWwindow* window, double xpos, double ypos);
 static void OnScroll(GLFWwindow* window, double xoffset, double yoffset);
 static void OnMouseButton(GLFWwindow* window, int button, int action, int mods);
+static void OnFocus(GLFWwindow* window, int focused);
+static void OnIconify(GLFWwindow* window, int iconified);
+static void OnRefresh(GLFWwindow* window);
 
 static GLFWwindow* CreateWindow();
 static void SetWindowIcon(std::string path);
@@ -75,29 +100,60 @@ int main()
 	SceneSetup();
 	glEnable(GL_DEPTH_TEST);
 
+	// From here on the scene is read by the simulation thread, edits hold its mutex
+	scene->StartSimulation();
+
 	while (!ShouldClose())
 	{
-		glfwPollEvents();
+		// An idle editor sleeps until an event arrives. Not under the scene mutex, the
+		// simulation keeps building meanwhile: callbacks editing the scene lock it themselves.
+		WaitForEvents();
 
-		// Timer
-		timer.Update(glfwGetTime());
-		UpdatePerformanceDisplay();
+		{
+			std::lock_guard<std::mutex> lock(scene->GetMutex());
 
-		// UI
-		imGui.Update(isCursorDisabled, scene.get());
-		
-		// Inputs
-		ProcessCameraInput();
+			// Timer
+			timer.Update(glfwGetTime());
+			UpdatePerformanceDisplay();
+
+			// UI
+			imGui.Update(isCursorDisabled, scene.get());
+
+			// Inputs
+			ProcessCameraInput();
+
+			// Held keys, a dragged widget and edits keep the frames coming
+			if (scene->HasPendingChanges() || imGui.IsActive())
+				RequestRedraw();
+		}
+
+		// Shaders no draw has needed yet keep compiling in the background
+		if (ShaderManager::Get().Update() > 0)
+			RequestRedraw();
 
-		// Draw
+		if (!ShouldDraw())
+		{
+			imGui.EndFrame();
+			continue;
+		}
+
+		// Draw the last frame built by the simulation, the next one is built meanwhile
 		ClearBuffers();
 		scene->Draw();
 		CheckOpenGLErrors();
 		imGui.Render();
 
 		glfwSwapBuffers(window);
+
+		// Resources removed this frame are deleted once the GPU is done with them
+		GpuDeletionQueue::Get().EndFrame();
 	}
 
+	// The scene is released while the context is still current so its GL objects are actually deleted
+	scene->StopSimulation();
+	scene.reset();
+	GpuDeletionQueue::Get().Flush();
+
 	Shutdown();
 	return 0;
 }
@@ -132,6 +188,9 @@ static int Init()
 
 	PrintDefault();
 
+	// Shaders created from here on compile on the driver threads when it can
+	ShaderManager::Get().Initialize();
+
 	// Viewport init
 	glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 	glfwSetFramebufferSizeCallback(window, OnResize);
@@ -142,14 +201,24 @@ static int Init()
 	glfwSetCursorPosCallback(window, OnMouse);
 	glfwSetScrollCallback(window, OnScroll);
 	glfwSetMouseButtonCallback(window, OnMouseButton);
+	glfwSetWindowFocusCallback(window, OnFocus);
+	glfwSetWindowIconifyCallback(window, OnIconify);
+	glfwSetWindowRefreshCallback(window, OnRefresh);
 
+	// Installed after the callbacks above, ImGui forwards the events to them
 	imGui.Init(window);
+
+	// Worker threads for the scene systems, started before the simulation thread submits work
+	JobSystem::Get().Init();
+	LOG("Job system running on " << JobSystem::Get().GetWorkerCount() << " threads");
+	LOG("Batch transforms using the " << BatchTransform::GetKernelName() << " kernel");
 	
 	return 1;
 }
 
 static void Shutdown()
 {
+	JobSystem::Get().Shutdown();
 	imGui.Shutdown();
 	glfwTerminate();
 }
@@ -206,6 +275,53 @@ static void CheckOpenGLErrors()
 	}
 }
 
+static void RequestRedraw()
+{
+	redrawFrames = REDRAW_FRAMES;
+}
+
+static void WaitForEvents()
+{
+	double waitStart = glfwGetTime();
+	if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) || (isEventDriven && redrawFrames == 0))
+	{
+		// Idle, the last frames were drawn so the simulation has nothing left to build
+		glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+
+		// Not frame time, the camera would jump on the next key press
+		timer.Skip(static_cast<float>(glfwGetTime() - waitStart));
+	}
+	else if (!isWindowFocused && lastDrawTime + 1.0 / UNFOCUSED_FRAME_RATE > waitStart)
+	{
+		// Sleeps until the next frame of the capped rate, events still wake it up
+		glfwWaitEventsTimeout(lastDrawTime + 1.0 / UNFOCUSED_FRAME_RATE - waitStart);
+	}
+	else
+	{
+		glfwPollEvents();
+	}
+}
+
+static bool ShouldDraw()
+{
+	// Nothing is visible, the framebuffer may even be empty
+	if (glfwGetWindowAttrib(window, GLFW_ICONIFIED))
+		return false;
+
+	if (isEventDriven && redrawFrames == 0)
+		return false;
+
+	// Events arriving between two frames of the capped rate wait for the next one
+	double now = glfwGetTime();
+	if (!isWindowFocused && now - lastDrawTime < 1.0 / UNFOCUSED_FRAME_RATE)
+		return false;
+
+	if (redrawFrames > 0)
+		redrawFrames--;
+	lastDrawTime = now;
+	return true;
+}
+
 static void SceneSetup()
 {
 	Cubesphere sphere(1.0f, 3, true);
@@ -255,16 +371,31 @@ static void SceneSetup()
 		-0.5f,  0.5f, -0.5f, 0.0f,  1.0f,  0.0f,  1.0f,  1.0f
 	};
 
+	// Shaders first, the driver compiles them while the rest of the scene loads.
+	// Timed to compare launches with a cold and a warm program cache.
+	double shaderStart = glfwGetTime();
+	std::unique_ptr<Shader> shader = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/default.frag");
+	shader->SetName("Default");
+	std::unique_ptr<Shader> gouraud = std::make_unique<Shader>("res/shaders/gouraud.vert", "res/shaders/gouraud.frag");
+	gouraud->SetName("Gouraud (non-textured only)");
+	std::unique_ptr<Shader> flat = std::make_unique<Shader>("res/shaders/flat.vert", "res/shaders/flat.frag");
+	flat->SetName("Flat (non-textured only)");
+	std::unique_ptr<Shader> gooch = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/gooch.frag");
+	gooch->SetName("Gooch (currently not working)");
+	std::unique_ptr<Shader> pointLightShader = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/point_light.frag");
+	pointLightShader->SetName("Point light (to remove)");
+	double shaderIssued = glfwGetTime();
+
 	// Meshes
-	std::unique_ptr<Mesh> cubeMesh = std::make_unique<Mesh>("Cube", cubeVertices, sizeof(cubeVertices), VertexLayout::VFNFTF);
-	std::unique_ptr<Mesh> sphereMesh = std::make_unique<Mesh>("Sphere", sphereVertices, sphereVerticesSize, VertexLayout::VFNF, sphere.getIndices(), sphere.getIndexSize());
+	MeshHandle cubeMesh = scene->AddMesh(std::make_unique<Mesh>("Cube", cubeVertices, sizeof(cubeVertices), VertexLayout::VFNFTF));
+	MeshHandle sphereMesh = scene->AddMesh(std::make_unique<Mesh>("Sphere", sphereVertices, sphereVerticesSize, VertexLayout::VFNF, sphere.getIndices(), sphere.getIndexSize()));
 
 	// Textures
-	std::unique_ptr<Texture> container = std::make_unique<Texture>("res/textures/container.png");
-	std::unique_ptr<Texture> containerSpec = std::make_unique<Texture>("res/textures/container_specular.png");
-	std::unique_ptr<Texture> containerEmis = std::make_unique<Texture>("res/textures/container_emission_2.png");
-	std::unique_ptr<Texture> wall = std::make_unique<Texture>("res/textures/wall.jpg");
-	std::unique_ptr<Texture> cobblestone = std::make_unique<Texture>("res/textures/cobblestone.jpg");
+	TextureHandle container = scene->AddTexture(std::make_unique<Texture>("res/textures/container.png"));
+	TextureHandle containerSpec = scene->AddTexture(std::make_unique<Texture>("res/textures/container_specular.png"));
+	TextureHandle containerEmis = scene->AddTexture(std::make_unique<Texture>("res/textures/container_emission_2.png"));
+	TextureHandle wall = scene->AddTexture(std::make_unique<Texture>("res/textures/wall.jpg"));
+	TextureHandle cobblestone = scene->AddTexture(std::make_unique<Texture>("res/textures/cobblestone.jpg"));
 
 	// Non-textured materials
 	std::unique_ptr<Material> defaultMat = std::make_unique<Material>("Default");
@@ -294,64 +425,12 @@ static void SceneSetup()
 	std::unique_ptr<Material> yellowRubberMat = std::make_unique<Material>("Yellow Rubber", glm::vec3(0.05f, 0.05f, 0.0f), glm::vec3(0.5f, 0.5f, 0.4f), glm::vec3(0.7f, 0.7f, 0.04f), 128 * 0.078125f);
 
 	// Textures materials
-	std::unique_ptr<Material> containerMat = std::make_unique<Material>("Container", container.get(), containerSpec.get(), 32.0f);
-	containerMat->SetEmissionMap(containerEmis.get());
-	std::unique_ptr<Material> wallMat = std::make_unique<Material>("Wall", wall.get(), nullptr, 32.0f);
-	std::unique_ptr<Material> cobblestoneMat = std::make_unique<Material>("Cobblestone", cobblestone.get(), nullptr, 32.0f);
-
-	// Shaders
-	std::unique_ptr<Shader> shader = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/default.frag");
-	shader->SetName("Default");
-	std::unique_ptr<Shader> gouraud = std::make_unique<Shader>("res/shaders/gouraud.vert", "res/shaders/gouraud.frag");
-	gouraud->SetName("Gouraud (non-textured only)");
-	std::unique_ptr<Shader> flat = std::make_unique<Shader>("res/shaders/flat.vert", "res/shaders/flat.frag");
-	flat->SetName("Flat (non-textured only)");
-	std::unique_ptr<Shader> gooch = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/gooch.frag");
-	gooch->SetName("Gooch (currently not working)");
-	std::unique_ptr<Shader> pointLightShader = std::make_unique<Shader>("res/shaders/default.vert", "res/shaders/point_light.frag");
-	pointLightShader->SetName("Point light (to remove)");
+	std::unique_ptr<Material> containerMat = std::make_unique<Material>("Container", container, containerSpec, 32.0f);
+	containerMat->SetEmissionMap(containerEmis);
+	std::unique_ptr<Material> wallMat = std::make_unique<Material>("Wall", wall, TextureHandle(), 32.0f);
+	std::unique_ptr<Material> cobblestoneMat = std::make_unique<Material>("Cobblestone", cobblestone, TextureHandle(), 32.0f);
 
-	// Point lights
-	std::unique_ptr<PointLight> pl1 = std::make_unique<PointLight>("Red point light", sphereMesh.get(), defaultMat.get(), pointLightShader.get());
-	pl1->SetPosition(glm::vec3(1.0f, 0.0f, 0.0f));
-	pl1->SetScale(glm::vec3(0.2));
-	pl1->SetColor(glm::vec3(0.7f, 0.0f, 0.0f));
-	pl1->SetAmbient(0.2f * glm::vec3(0.7f, 0.0f, 0.0f));
-	pl1->SetDiffuse(0.5f * glm::vec3(0.7f, 0.0f, 0.0f));
-	pl1->SetSpecular(glm::vec3(0.7f, 0.0f, 0.0f));
-
-	std::unique_ptr<PointLight> pl2 = std::make_unique<PointLight>("Green point light", sphereMesh.get(), defaultMat.get(), pointLightShader.get());
-	pl2->SetPosition(glm::vec3(-1.0f, 0.0f, 0.0f));
-	pl2->SetScale(glm::vec3(0.2));
-	pl2->SetColor(glm::vec3(0.0f, 0.7f, 0.0f));
-	pl2->SetAmbient(0.2f * glm::vec3(0.0f, 0.7f, 0.0f));
-	pl2->SetDiffuse(0.5f * glm::vec3(0.0f, 0.7f, 0.0f));
-	pl2->SetSpecular(glm::vec3(0.0f, 0.7f, 0.0f));
-
-	std::unique_ptr<PointLight> pl3 = std::make_unique<PointLight>("Blue point light", sphereMesh.get(), defaultMat.get(), pointLightShader.get());
-	pl3->SetPosition(glm::vec3(0.0f, 1.0f, 0.0f));
-	pl3->SetScale(glm::vec3(0.2));
-	pl3->SetColor(glm::vec3(0.0f, 0.0f, 0.7f));
-	pl3->SetAmbient(0.2f * glm::vec3(0.0f, 0.0f, 0.7f));
-	pl3->SetDiffuse(0.5f * glm::vec3(0.0f, 0.0f, 0.7f));
-	pl3->SetSpecular(glm::vec3(0.0f, 0.0f, 0.7f));
-
-	// Objects
-	std::unique_ptr<Object> obj1 = std::make_unique<Object>("Default cube", cubeMesh.get(), defaultMat.get(), shader.get());
-	std::unique_ptr<Object> obj2 = std::make_unique<Object>("Default floor", cubeMesh.get(), defaultMat.get(), shader.get());
-	obj2->SetScale(glm::vec3(10.0f, 0.1f, 10.0f));
-	obj2->SetPosition(glm::vec3(0.0f, -1.0f, 0.0f));
-
-	scene->AddMesh(std::move(cubeMesh));
-	scene->AddMesh(std::move(sphereMesh));
-
-	scene->AddTexture(std::move(container));
-	scene->AddTexture(std::move(containerSpec));
-	scene->AddTexture(std::move(containerEmis));
-	scene->AddTexture(std::move(wall));
-	scene->AddTexture(std::move(cobblestone));
-
-	scene->AddMaterial(std::move(defaultMat));
+	MaterialHandle defaultMaterial = scene->AddMaterial(std::move(defaultMat));
 	scene->AddMaterial(std::move(emeraldMat));
 	scene->AddMaterial(std::move(jadeMat));
 	scene->AddMaterial(std::move(obsidianMat));
@@ -381,22 +460,35 @@ static void SceneSetup()
 	scene->AddMaterial(std::move(wallMat));
 	scene->AddMaterial(std::move(cobblestoneMat));
 
-	scene->AddShader(std::move(shader));
+	ShaderHandle defaultShader = scene->AddShader(std::move(shader));
 	scene->AddShader(std::move(gouraud));
 	scene->AddShader(std::move(flat));
 	scene->AddShader(std::move(gooch));
-	scene->AddShader(std::move(pointLightShader));
-
-	scene->AddPointLight(std::move(pl1));
-	scene->AddPointLight(std::move(pl2));
-	scene->AddPointLight(std::move(pl3));
-
-	scene->AddObject(std::move(obj1));
-	scene->AddObject(std::move(obj2));
+	ShaderHandle lightShader = scene->AddShader(std::move(pointLightShader));
+
+	// Entities
+	scene->CreatePointLight("Red point light", sphereMesh, defaultMaterial, lightShader, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.7f, 0.0f, 0.0f));
+	scene->CreatePointLight("Green point light", sphereMesh, defaultMaterial, lightShader, glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.7f, 0.0f));
+	scene->CreatePointLight("Blue point light", sphereMesh, defaultMaterial, lightShader, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.7f));
+
+	scene->CreateObject("Default cube", cubeMesh, defaultMaterial, defaultShader);
+	Entity floor = scene->CreateObject("Default floor", cubeMesh, defaultMaterial, defaultShader);
+	TransformComponent* floorTransform = scene->GetWorld().Get<TransformComponent>(floor);
+	floorTransform->scale = glm::vec3(10.0f, 0.1f, 10.0f);
+	floorTransform->position = glm::vec3(0.0f, -1.0f, 0.0f);
+
+	// The shaders still compiling are finished by their first draw or a later Update
+	size_t compiling = ShaderManager::Get().Update();
+	ProgramCache& programCache = ProgramCache::Get();
+	std::cout << "Shaders issued in " << (shaderIssued - shaderStart) * 1000.0 << " ms, "
+		<< compiling << " still compiling after " << (glfwGetTime() - shaderStart) * 1000.0 << " ms of scene setup ("
+		<< programCache.GetHitCount() << " cached, " << programCache.GetMissCount() << " compiled)" << std::endl;
 }
 
 static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+	RequestRedraw();
+
 	switch (key)
 	{
 	case GLFW_KEY_ESCAPE:
@@ -460,10 +552,23 @@ static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, in
 
 		if (action == GLFW_PRESS)
 		{
+			std::lock_guard<std::mutex> lock(scene->GetMutex());
 			scene->ToggleFlashlight();
 		}
 		break;
 	}
+	case GLFW_KEY_R:
+	{
+		if (!isCursorDisabled)
+			break;
+
+		if (action == GLFW_PRESS)
+		{
+			isEventDriven = !isEventDriven;
+			LOG("Event-driven rendering: " << (isEventDriven ? "ON" : "OFF"));
+		}
+		break;
+	}
 	}
 }
 
@@ -482,22 +587,36 @@ static void OnMouse(GLFWwindow* window, double xpos, double ypos)
 	lastY = ypos;
 		
 	if (isCursorDisabled)
+	{
+		std::lock_guard<std::mutex> lock(scene->GetMutex());
 		camera.ProcessMouseMovement(xOffset, yOffset);
+	}
+
+	// Hovering the UI changes it too
+	RequestRedraw();
 }
 
 static void OnScroll(GLFWwindow* window, double xoffset, double yoffset)
 {
 	if (isCursorDisabled)
+	{
+		std::lock_guard<std::mutex> lock(scene->GetMutex());
 		camera.UpdateFOV(yoffset);
+	}
+
+	RequestRedraw();
 }
 
 static void OnResize(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	RequestRedraw();
 }
 
 static void OnMouseButton(GLFWwindow* window, int button, int action, int mods)
 {
+	RequestRedraw();
+
 	if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
 	{
 		if (!isCursorDisabled)
@@ -513,6 +632,23 @@ static void OnMouseButton(GLFWwindow* window, int button, int action, int mods)
 	}
 }
 
+static void OnFocus(GLFWwindow* window, int focused)
+{
+	isWindowFocused = focused == GLFW_TRUE;
+	RequestRedraw();
+}
+
+static void OnIconify(GLFWwindow* window, int iconified)
+{
+	RequestRedraw();
+}
+
+static void OnRefresh(GLFWwindow* window)
+{
+	// Uncovered or resized, the last frame is gone
+	RequestRedraw();
+}
+
 static GLFWwindow* CreateWindow()
 {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -547,6 +683,7 @@ static void PrintDefault()
 	LOG("Right click to toggle mouse visibility");
 	LOG("Press G to toggle wireframe mode");
 	LOG("Press F to toggle flashlight");
+	LOG("Press R to toggle event-driven rendering (redraws only when something changes)");
 	LOG("Use WASD and mouse to move around (scroll to zoom)");
 }
 
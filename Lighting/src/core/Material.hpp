@@ -2,7 +2,7 @@
 
 #include <glm/glm.hpp>
 #include <string>
-#include "Texture.h"
+#include "resource/Handle.h"
 
 class Material
 {
@@ -11,7 +11,7 @@ public:
 	Material(std::string&& name) :
 		m_Name(name), 
 		m_Ambient(glm::vec3(1.0f)), m_Diffuse(glm::vec3(1.0f)), m_Specular(glm::vec3(0.5f)), m_Shininess(32.0f),
-		m_DiffuseMap(nullptr), m_SpecularMap(nullptr), m_EmissionMap(nullptr)
+		m_DiffuseMap(), m_SpecularMap(), m_EmissionMap(), m_IsDirty(true)
 	{
 	}
 
@@ -19,27 +19,27 @@ public:
 	Material(std::string&& name, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess) :
 		m_Name(name),
 		m_Ambient(ambient), m_Diffuse(diffuse), m_Specular(specular), m_Shininess(shininess),
-		m_DiffuseMap(nullptr), m_SpecularMap(nullptr), m_EmissionMap(nullptr)
+		m_DiffuseMap(), m_SpecularMap(), m_EmissionMap(), m_IsDirty(true)
 	{
 	}
 
-	// Textured constructor
-	Material(std::string&& name, Texture* diffuseMap, Texture* specularMap, float shininess) :
+	// Textured constructor, the maps are resolved through the scene resources
+	Material(std::string&& name, TextureHandle diffuseMap, TextureHandle specularMap, float shininess) :
 		m_Name(name),
 		m_Ambient(glm::vec3(1.0f)), m_Diffuse(glm::vec3(1.0f)), m_Specular(glm::vec3(0.5f)), m_Shininess(shininess),
-		m_DiffuseMap(diffuseMap), m_SpecularMap(specularMap), m_EmissionMap(nullptr)
+		m_DiffuseMap(diffuseMap), m_SpecularMap(specularMap), m_EmissionMap(), m_IsDirty(true)
 	{
 	}
 
 	// Setters
 	void SetName(const std::string& name) { m_Name = name; }
-	void SetAmbient(const glm::vec3& ambient) { m_Ambient = ambient; }
-	void SetDiffuse(const glm::vec3& diffuse) { m_Diffuse = diffuse; }
-	void SetSpecular(const glm::vec3& specular) { m_Specular = specular; }
-	void SetShininess(float shininess) { m_Shininess = shininess; }
-	void SetDiffuseMap(Texture* diffuseMap) { m_DiffuseMap = diffuseMap; }
-	void SetSpecularMap(Texture* specularMap) { m_SpecularMap = specularMap; }
-	void SetEmissionMap(Texture* emissionMap) { m_EmissionMap = emissionMap; }
+	void SetAmbient(const glm::vec3& ambient) { m_Ambient = ambient; m_IsDirty = true; }
+	void SetDiffuse(const glm::vec3& diffuse) { m_Diffuse = diffuse; m_IsDirty = true; }
+	void SetSpecular(const glm::vec3& specular) { m_Specular = specular; m_IsDirty = true; }
+	void SetShininess(float shininess) { m_Shininess = shininess; m_IsDirty = true; }
+	void SetDiffuseMap(TextureHandle diffuseMap) { m_DiffuseMap = diffuseMap; m_IsDirty = true; }
+	void SetSpecularMap(TextureHandle specularMap) { m_SpecularMap = specularMap; m_IsDirty = true; }
+	void SetEmissionMap(TextureHandle emissionMap) { m_EmissionMap = emissionMap; m_IsDirty = true; }
 
 	// Getters
 	const std::string& GetName() const { return m_Name; }
@@ -47,9 +47,13 @@ public:
 	const glm::vec3& GetDiffuse() const { return m_Diffuse; }
 	const glm::vec3& GetSpecular() const { return m_Specular; }
 	float GetShininess() const { return m_Shininess; }
-	Texture* GetDiffuseMap() const { return m_DiffuseMap; }
-	Texture* GetSpecularMap() const { return m_SpecularMap; }
-	Texture* GetEmissionMap() const { return m_EmissionMap; }
+	TextureHandle GetDiffuseMap() const { return m_DiffuseMap; }
+	TextureHandle GetSpecularMap() const { return m_SpecularMap; }
+	TextureHandle GetEmissionMap() const { return m_EmissionMap; }
+
+	// Set by the setters, cleared once the material buffer has the new values
+	bool IsDirty() const { return m_IsDirty; }
+	void ClearDirty() { m_IsDirty = false; }
 
 private:
 	std::string m_Name;
@@ -59,7 +63,9 @@ private:
 	glm::vec3 m_Specular;
 	float m_Shininess;
 
-	Texture* m_DiffuseMap;
-	Texture* m_SpecularMap;
-	Texture* m_EmissionMap;
+	TextureHandle m_DiffuseMap;
+	TextureHandle m_SpecularMap;
+	TextureHandle m_EmissionMap;
+
+	bool m_IsDirty;
 };
\ No newline at end of file
@@ -1,37 +1,432 @@
 #include "Scene.h"
 
+#include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <iostream>
 
 Scene::Scene() :
 	m_Camera(Camera(CAMERA_RES_WIDTH, CAMERA_RES_HEIGHT, glm::vec3(0.0f, 0.0f, 3.0f))),
-	m_IsFlashlightOn(false)
+	m_IsFlashlightOn(false),
+	m_ResourceVersion(1),
+	m_IsSimulating(false), m_IsSnapshotRequested(false),
+	m_DrawListVersion(0), m_BuiltStructureVersion(0), m_BuiltResourceVersion(0),
+	m_BuiltView(1.0f), m_BuiltProjection(1.0f), m_BuiltFlashlight(false), m_StructureVersion(1),
+	m_DrawListRebuildCount(0), m_PatchedDrawCount(0), m_SkippedSnapshotCount(0),
+	m_IsDefragmenting(false), m_GeometryVersion(0),
+	m_UniformUploadCount(0), m_UniformSkipCount(0)
 {
 }
 
-void Scene::Draw()
+Scene::~Scene()
+{
+	StopSimulation();
+}
+
+void Scene::StartSimulation()
+{
+	if (m_SimulationThread.joinable())
+		return;
+
+	m_IsSimulating = true;
+	m_SimulationThread = std::thread(&Scene::SimulationLoop, this);
+	RequestSnapshot();
+}
+
+void Scene::StopSimulation()
+{
+	if (!m_SimulationThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_IsSimulating = false;
+	}
+	m_RequestCondition.notify_one();
+	m_SimulationThread.join();
+}
+
+void Scene::SimulationLoop()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_RequestMutex);
+			m_RequestCondition.wait(lock, [this]() { return m_IsSnapshotRequested || !m_IsSimulating; });
+			if (!m_IsSimulating)
+				return;
+			m_IsSnapshotRequested = false;
+		}
+
+		BuildSnapshot();
+	}
+}
+
+void Scene::RequestSnapshot()
 {
-	for (auto& pointLight : m_PointLights)
 	{
-		pointLight->SetViewAndProjectionMatrix(m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix());
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_IsSnapshotRequested = true;
+	}
+	m_RequestCondition.notify_one();
+}
 
-		for (auto& object : m_Objects)
+void Scene::BuildSnapshot()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	glm::mat4 view = m_Camera.GetViewMatrix();
+	glm::mat4 projection = m_Camera.GetProjectionMatrix();
+	bool isViewChanged = view != m_BuiltView || projection != m_BuiltProjection;
+	bool isChanged = isViewChanged || m_DirLight != m_BuiltDirLight || m_IsFlashlightOn != m_BuiltFlashlight;
+
+	// The retained draw list is only rebuilt when the scene changed structurally,
+	// a moving camera or a few moved objects patch it
+	if (m_BuiltStructureVersion != m_StructureVersion || m_BuiltResourceVersion != m_ResourceVersion)
+	{
+		RebuildDrawList(view, projection);
+		isChanged = true;
+	}
+	else
+	{
+		if (isViewChanged)
+			UpdateTransforms(view, projection);
+		if (!m_ChangedTransforms.empty())
 		{
-			pointLight->AffectObject(object.get());
+			PatchChangedTransforms(view, projection);
+			isChanged = true;
 		}
+	}
+	m_ChangedTransforms.clear();
+
+	// The render thread keeps drawing the snapshot it has
+	if (!isChanged)
+	{
+		m_SkippedSnapshotCount++;
+		return;
+	}
+
+	m_BuiltView = view;
+	m_BuiltProjection = projection;
+	m_BuiltDirLight = m_DirLight;
+	m_BuiltFlashlight = m_IsFlashlightOn;
+
+	RenderSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+	snapshot.view = view;
+	snapshot.projection = projection;
+	snapshot.dirLight = m_DirLight;
+	snapshot.isFlashlightOn = m_IsFlashlightOn;
+	snapshot.resourceVersion = m_ResourceVersion;
+	snapshot.transforms = m_RetainedFrame.transforms;
+	if (snapshot.drawListVersion != m_DrawListVersion)
+	{
+		snapshot.drawList = m_RetainedDrawList;
+		snapshot.drawListVersion = m_DrawListVersion;
+	}
+
+	m_Snapshots.Publish();
+}
+
+void Scene::RebuildDrawList(const glm::mat4& view, const glm::mat4& projection)
+{
+	UpdateSystems(view, projection, m_RetainedFrame);
+	m_RetainedDrawList.Build(m_RetainedFrame, view, m_Resources);
+	m_RetainedDrawList.geometryVersion = m_GeometryVersion;
+	m_DrawListVersion++;
+	m_DrawListRebuildCount++;
 
-		pointLight->Draw();
+	// Where each entity ended up after the sort, for the transform edits
+	for (RetainedSlot& slot : m_RetainedSlots)
+		slot.entity = Entity();
+	for (size_t i = 0; i < m_RetainedFrame.renderItems.size(); i++)
+	{
+		const Entity& entity = m_RetainedFrame.renderItems[i].entity;
+		if (entity.index >= m_RetainedSlots.size())
+			m_RetainedSlots.resize(entity.index + 1);
+		m_RetainedSlots[entity.index] = { entity, static_cast<unsigned int>(i) };
 	}
 
-	for (auto& object : m_Objects)
+	m_BuiltStructureVersion = m_StructureVersion;
+	m_BuiltResourceVersion = m_ResourceVersion;
+}
+
+void Scene::UpdateTransforms(const glm::mat4& view, const glm::mat4& projection)
+{
+	// Same inputs, the transforms and light positions are in view space
+	JobSystem& jobs = JobSystem::Get();
+	jobs.Wait(TransformSystem::Schedule(view, projection, m_RetainedFrame, nullptr));
+	m_RetainedDrawList.UpdateLights(m_RetainedFrame, view);
+	m_DrawListVersion++;
+}
+
+void Scene::PatchChangedTransforms(const glm::mat4& view, const glm::mat4& projection)
+{
+	for (const Entity& entity : m_ChangedTransforms)
+	{
+		// Entities not drawn have no entry
+		if (entity.index >= m_RetainedSlots.size() || m_RetainedSlots[entity.index].entity != entity)
+			continue;
+		const TransformComponent* transform = m_World.Get<TransformComponent>(entity);
+		if (!transform)
+			continue;
+
+		unsigned int drawIndex = m_RetainedSlots[entity.index].drawIndex;
+		RenderItem& item = m_RetainedFrame.renderItems[drawIndex];
+		m_RetainedFrame.transformInputs.Set(item.transformIndex, transform->position, transform->orientation, transform->scale);
+		BatchTransform::ComputeRange(m_RetainedFrame.transformInputs, view, projection, m_RetainedFrame.transforms.data(), item.transformIndex, item.transformIndex + 1);
+
+		item.bounds = GetBounds(item.mesh, *transform);
+		m_PatchedLights.clear();
+		unsigned int lightCount = LightAssignmentSystem::Assign(item.bounds, m_RetainedFrame.pointLights, m_PatchedLights);
+		m_RetainedDrawList.PatchDraw(drawIndex, item.bounds, m_PatchedLights.data(), lightCount);
+		m_PatchedDrawCount++;
+	}
+	m_DrawListVersion++;
+}
+
+bool Scene::AcquireSnapshot()
+{
+	if (!m_SimulationThread.joinable())
 	{
-		object->SetViewAndProjectionMatrix(m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix());
-		object->SetDirectionalLight(m_DirLight.GetDirection(), m_DirLight.GetAmbient(), m_DirLight.GetDiffuse(), m_DirLight.GetSpecular());
-		
-		object->SetFlashlight(m_IsFlashlightOn);
+		BuildSnapshot();
+		return m_Snapshots.Acquire();
+	}
+
+	bool isAcquired = m_Snapshots.Acquire();
 
-		object->Draw();
+	// Only happens on the first frame and right after a resource was removed from the UI
+	while (m_Snapshots.GetReadBuffer().resourceVersion != m_ResourceVersion)
+	{
+		RequestSnapshot();
+		while (!m_Snapshots.Acquire())
+			std::this_thread::yield();
+		isAcquired = true;
 	}
+
+	// The next frame is built while this one is submitted
+	RequestSnapshot();
+	return isAcquired;
+}
+
+void Scene::Draw()
+{
+	UpdateGeometry();
+	bool isNewSnapshot = AcquireSnapshot();
+	RenderSnapshot& snapshot = m_Snapshots.GetReadBuffer();
+	const DrawList& drawList = snapshot.drawList;
+
+	// Materials only change when edited, they are not part of the snapshot
+	m_MaterialBuffer.Update(m_Resources);
+	m_MaterialBuffer.BindBase(MATERIAL_DATA_BINDING);
+
+	// Snapshots built before meshes moved still point to their old ranges
+	bool isGeometryPatched = snapshot.drawList.geometryVersion != m_GeometryVersion;
+	if (isGeometryPatched)
+		snapshot.drawList.PatchGeometry(m_Geometry, m_GeometryVersion);
+
+	// An unchanged snapshot is still bound and culled from last frame
+	if (isNewSnapshot || isGeometryPatched)
+	{
+		UploadDrawList(snapshot);
+		CullDraws(snapshot);
+	}
+
+	// The whole pass reads its geometry from the shared buffers, one multi-draw per group.
+	// The GPU wrote the visible commands and how many there are in each group.
+	m_Geometry.Bind();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_VisibleCommandBuffer.GetId());
+	glBindBuffer(GL_PARAMETER_BUFFER, m_DrawCountBuffer.GetId());
+
+	// Variants without the flashlight or point light code when the frame does not need it
+	unsigned int frameFeatures = (snapshot.isFlashlightOn ? SHADER_FEATURE_FLASHLIGHT : 0) |
+		(!drawList.pointLights.empty() ? SHADER_FEATURE_POINT_LIGHTS : 0);
+
+	// Programs keep their uniforms, each block is sent again only when it changed
+	UpdateUniformStates(snapshot);
+	for (size_t i = 0; i < drawList.groups.size(); i++)
+	{
+		const DrawGroup& group = drawList.groups[i];
+
+		group.shader->Use(frameFeatures | group.features);
+		BindFrameUniforms(group.shader);
+
+		BindGroupTextures(group);
+		glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(const void*)(group.firstCommand * sizeof(DrawElementsIndirectCommand)),
+			(GLintptr)(i * sizeof(unsigned int)), group.commandCount, 0);
+	}
+	m_Geometry.Unbind();
+
+	// The region these draws read is reused once the GPU is done with them
+	m_DynamicBuffer.EndFrame();
+}
+
+void Scene::CullDraws(const RenderSnapshot& snapshot)
+{
+	const DrawList& drawList = snapshot.drawList;
+	if (drawList.commands.empty())
+		return;
+
+	// Loaded on first use, the scene is created before the GL context
+	if (!m_CullShader)
+		m_CullShader = std::make_unique<Shader>("res/shaders/cull.comp");
+
+	Frustum frustum = Frustum::FromMatrix(snapshot.projection * snapshot.view);
+
+	m_CullShader->Use();
+	m_CullShader->SetInt("u_drawCount", static_cast<int>(drawList.commands.size()));
+	for (int i = 0; i < 6; i++)
+		m_CullShader->SetVec4("u_frustumPlanes[" + std::to_string(i) + "]", frustum.planes[i]);
+
+	glDispatchCompute(static_cast<GLuint>((drawList.commands.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE), 1, 1);
+
+	// The commands and counts are read by the indirect draws
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void Scene::UpdateGeometry()
+{
+	// Mesh ranges are read by the simulation when it builds the draw list
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	// Meshes added since the last frame
+	m_Geometry.Upload();
+
+	// Snapshots built before a move point to the old ranges, Draw patches them
+	m_IsDefragmenting = m_Geometry.Defragment(GEOMETRY_DEFRAGMENT_BUDGET);
+	if (m_IsDefragmenting)
+	{
+		for (auto& mesh : m_Resources.GetMeshes())
+			mesh->SetGeometryRange(m_Geometry.GetRange(mesh->GetGeometryRange().id));
+		m_GeometryVersion++;
+	}
+}
+
+void Scene::UpdateSystems(const glm::mat4& view, const glm::mat4& projection, FrameData& frame)
+{
+	// Transforms and light assignment only read the extracted items, they run side by side
+	JobSystem& jobs = JobSystem::Get();
+	Job* culling = CullingSystem::Schedule(m_World, m_Resources, nullptr);
+	Job* extraction = RenderExtractionSystem::Schedule(m_World, m_Resources, frame, culling);
+	Job* transforms = TransformSystem::Schedule(view, projection, frame, extraction);
+	Job* lights = LightAssignmentSystem::Schedule(frame, extraction);
+	Job* sort = RenderExtractionSystem::ScheduleSort(m_Resources, frame, lights);
+
+	Job* done = jobs.Create(nullptr);
+	jobs.AddDependency(done, transforms);
+	jobs.AddDependency(done, sort);
+	jobs.Run(done);
+	jobs.Wait(done);
+}
+
+void Scene::UploadDrawList(const RenderSnapshot& snapshot)
+{
+	const DrawList& drawList = snapshot.drawList;
+	const std::vector<ObjectTransform>& transforms = snapshot.transforms;
+
+	size_t transformsSize = transforms.size() * sizeof(ObjectTransform);
+	size_t drawsSize = drawList.draws.size() * sizeof(DrawData);
+	size_t pointLightsSize = drawList.pointLights.size() * sizeof(PointLightGpuData);
+	size_t lightIndicesSize = drawList.lightIndices.size() * sizeof(unsigned int);
+	size_t cullInputsSize = drawList.cullInputs.size() * sizeof(CullData);
+	size_t commandsSize = drawList.commands.size() * sizeof(DrawElementsIndirectCommand);
+
+	// A fixed number of writes whatever the number of objects, straight into mapped memory
+	m_DynamicBuffer.BeginFrame(transformsSize + drawsSize + pointLightsSize + lightIndicesSize + cullInputsSize + commandsSize, 6);
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, OBJECT_TRANSFORMS_BINDING, m_DynamicBuffer.Write(transforms.data(), transformsSize));
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_DynamicBuffer.Write(drawList.draws.data(), drawsSize));
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, POINT_LIGHTS_BINDING, m_DynamicBuffer.Write(drawList.pointLights.data(), pointLightsSize));
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, LIGHT_INDICES_BINDING, m_DynamicBuffer.Write(drawList.lightIndices.data(), lightIndicesSize));
+
+	// Every command goes in, cull.comp writes the visible ones and the count of each group
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, CULL_INPUTS_BINDING, m_DynamicBuffer.Write(drawList.cullInputs.data(), cullInputsSize));
+	m_DynamicBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_BINDING, m_DynamicBuffer.Write(drawList.commands.data(), commandsSize));
+	m_VisibleCommandBuffer.Reserve(GL_SHADER_STORAGE_BUFFER, commandsSize);
+	m_VisibleCommandBuffer.BindBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_COMMANDS_BINDING);
+	m_DrawCountBuffer.Reserve(GL_SHADER_STORAGE_BUFFER, drawList.groups.size() * sizeof(unsigned int));
+	m_DrawCountBuffer.Clear(GL_SHADER_STORAGE_BUFFER, drawList.groups.size() * sizeof(unsigned int));
+	m_DrawCountBuffer.BindBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNTS_BINDING);
+}
+
+void Scene::UpdateUniformStates(const RenderSnapshot& snapshot)
+{
+	const glm::mat4& view = snapshot.view;
+	const DirectionalLight& dirLight = snapshot.dirLight;
+	m_ViewState.Set(view);
+
+	// Lighting is done in view space, the direction changes with the camera
+	DirLightState dirLightState;
+	dirLightState.direction = glm::vec3(view * glm::vec4(dirLight.GetDirection(), 0.0f));
+	dirLightState.ambient = dirLight.GetAmbient();
+	dirLightState.diffuse = dirLight.GetDiffuse();
+	dirLightState.specular = dirLight.GetSpecular();
+	m_DirLightState.Set(dirLightState);
+
+	SpotLightState spotLightState;
+	spotLightState.direction = glm::vec3(0.0f, 0.0f, -1.0f);
+	spotLightState.ambient = 0.2f * glm::vec3(1.0f, 0.902f, 0.784f);
+	spotLightState.diffuse = 0.5f * glm::vec3(1.0f, 0.902f, 0.784f);
+	spotLightState.specular = glm::vec3(1.0f, 0.902f, 0.784f);
+	spotLightState.cutOff = glm::cos(glm::radians(12.5f));
+	spotLightState.outerCutOff = glm::cos(glm::radians(17.5f));
+	m_SpotLightState.Set(spotLightState);
+
+	m_UniformUploadCount = 0;
+	m_UniformSkipCount = 0;
+}
+
+void Scene::BindFrameUniforms(Shader* shader)
+{
+	if (shader->ShouldUpload(SHADER_BLOCK_VIEW, m_ViewState.GetVersion()))
+	{
+		shader->SetMat4("u_view", m_ViewState.Get());
+		m_UniformUploadCount++;
+	}
+	else
+	{
+		m_UniformSkipCount++;
+	}
+
+	if (shader->ShouldUpload(SHADER_BLOCK_DIR_LIGHT, m_DirLightState.GetVersion()))
+	{
+		const DirLightState& dirLight = m_DirLightState.Get();
+		shader->SetVec3("u_dirLight.direction", dirLight.direction);
+		shader->SetVec3("u_dirLight.ambient", dirLight.ambient);
+		shader->SetVec3("u_dirLight.diffuse", dirLight.diffuse);
+		shader->SetVec3("u_dirLight.specular", dirLight.specular);
+		m_UniformUploadCount++;
+	}
+	else
+	{
+		m_UniformSkipCount++;
+	}
+
+	if (shader->ShouldUpload(SHADER_BLOCK_SPOT_LIGHT, m_SpotLightState.GetVersion()))
+	{
+		const SpotLightState& spotLight = m_SpotLightState.Get();
+		shader->SetVec3("u_spotLight.direction", spotLight.direction);
+		shader->SetVec3("u_spotLight.ambient", spotLight.ambient);
+		shader->SetVec3("u_spotLight.diffuse", spotLight.diffuse);
+		shader->SetVec3("u_spotLight.specular", spotLight.specular);
+		shader->SetFloat("u_spotLight.cutOff", spotLight.cutOff);
+		shader->SetFloat("u_spotLight.outerCutOff", spotLight.outerCutOff);
+		m_UniformUploadCount++;
+	}
+	else
+	{
+		m_UniformSkipCount++;
+	}
+}
+
+void Scene::BindGroupTextures(const DrawGroup& group)
+{
+	// Without a diffuse map the untextured variant uses the material colors
+	if (group.diffuseArray == TEXTURE_ARRAY_NONE)
+		return;
+
+	// Units match the sampler bindings in the shaders, the layer of each draw's maps is in its material
+	m_TextureArrays.Bind(group.diffuseArray, 0);
+	m_TextureArrays.Bind(group.specularArray, 1);
+	m_TextureArrays.Bind(group.emissionArray, 2);
 }
 
 void Scene::ToggleFlashlight()
@@ -39,80 +434,122 @@ void Scene::ToggleFlashlight()
 	m_IsFlashlightOn = !m_IsFlashlightOn;
 }
 
-void Scene::AddObject(std::unique_ptr<Object> obj)
+Entity Scene::CreateObject(const std::string& name, MeshHandle mesh, MaterialHandle material, ShaderHandle shader)
 {
-	m_Objects.push_back(std::move(obj));
+	m_StructureVersion++;
+	return m_World.Create(NameComponent(name), TransformComponent(), MeshRendererComponent(mesh, material, shader));
 }
 
-void Scene::RemoveObject(size_t toDelete)
+Entity Scene::CreatePointLight(const std::string& name, MeshHandle mesh, MaterialHandle material, ShaderHandle shader, const glm::vec3& position, const glm::vec3& color)
 {
-	if (toDelete < m_Objects.size())
-		m_Objects.erase(m_Objects.begin() + toDelete);
+	m_StructureVersion++;
+	return m_World.Create(NameComponent(name), TransformComponent(position, glm::vec3(0.2f)),
+		MeshRendererComponent(mesh, material, shader), PointLightComponent(color));
+}
+
+void Scene::DestroyEntity(Entity entity)
+{
+	if (m_World.IsAlive(entity))
+	{
+		m_World.Destroy(entity);
+		m_StructureVersion++;
+	}
 	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+		std::cerr << "Invalid entity. It was already destroyed." << std::endl;
+}
+
+bool Scene::HasPendingChanges() const
+{
+	if (m_BuiltStructureVersion != m_StructureVersion || m_BuiltResourceVersion != m_ResourceVersion ||
+		!m_ChangedTransforms.empty() || m_IsDefragmenting)
+		return true;
+
+	if (m_Camera.GetViewMatrix() != m_BuiltView || m_Camera.GetProjectionMatrix() != m_BuiltProjection ||
+		m_DirLight != m_BuiltDirLight || m_IsFlashlightOn != m_BuiltFlashlight)
+		return true;
+
+	// Material edits go straight to the material buffer, not through the snapshot
+	for (const auto& material : m_Resources.GetMaterials())
+	{
+		if (material->IsDirty())
+			return true;
+	}
+	return false;
 }
 
-void Scene::AddPointLight(std::unique_ptr<PointLight> light)
+void Scene::MarkStructureChanged()
 {
-	m_PointLights.push_back(std::move(light));
+	m_StructureVersion++;
 }
 
-void Scene::RemovePointLight(size_t toDelete)
+void Scene::MarkTransformChanged(Entity entity)
 {
-	if (toDelete < m_PointLights.size())
-		m_PointLights.erase(m_PointLights.begin() + toDelete);
+	// A point light moving changes the lights of everything around it
+	if (m_World.Has<PointLightComponent>(entity))
+		MarkStructureChanged();
 	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+		m_ChangedTransforms.push_back(entity);
 }
 
-void Scene::AddMesh(std::unique_ptr<Mesh> mesh)
+MeshHandle Scene::AddMesh(std::unique_ptr<Mesh> mesh)
 {
-	m_Meshes.push_back(std::move(mesh));
+	mesh->SetGeometryRange(m_Geometry.Add(*mesh));
+	return m_Resources.GetMeshes().Add(std::move(mesh));
 }
 
-void Scene::RemoveMesh(size_t toDelete)
+void Scene::RemoveMesh(MeshHandle mesh)
 {
-	if (toDelete < m_Meshes.size())
-		m_Meshes.erase(m_Meshes.begin() + toDelete);
-	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+	// Entities still using it keep a stale handle and are skipped when drawing
+	m_ResourceVersion++;
+	Mesh* removed = m_Resources.GetMeshes().Get(mesh);
+	if (removed)
+		m_Geometry.Remove(removed->GetGeometryRange());
+
+	if (!m_Resources.GetMeshes().Remove(mesh))
+		std::cerr << "Invalid handle. The mesh was already removed." << std::endl;
 }
 
-void Scene::AddShader(std::unique_ptr<Shader> shader)
+ShaderHandle Scene::AddShader(std::unique_ptr<Shader> shader)
 {
-	m_Shaders.push_back(std::move(shader));
+	return m_Resources.GetShaders().Add(std::move(shader));
 }
 
-void Scene::RemoveShader(size_t toDelete)
+void Scene::RemoveShader(ShaderHandle shader)
 {
-	if (toDelete < m_Shaders.size())
-		m_Shaders.erase(m_Shaders.begin() + toDelete);
-	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+	m_ResourceVersion++;
+	if (!m_Resources.GetShaders().Remove(shader))
+		std::cerr << "Invalid handle. The shader was already removed." << std::endl;
 }
 
-void Scene::AddMaterial(std::unique_ptr<Material> material)
+MaterialHandle Scene::AddMaterial(std::unique_ptr<Material> material)
 {
-	m_Materials.push_back(std::move(material));
+	return m_Resources.GetMaterials().Add(std::move(material));
 }
 
-void Scene::RemoveMaterial(size_t toDelete)
+void Scene::RemoveMaterial(MaterialHandle material)
 {
-	if (toDelete < m_Materials.size())
-		m_Materials.erase(m_Materials.begin() + toDelete);
-	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+	m_ResourceVersion++;
+	if (!m_Resources.GetMaterials().Remove(material))
+		std::cerr << "Invalid handle. The material was already removed." << std::endl;
 }
 
-void Scene::AddTexture(std::unique_ptr<Texture> texture)
+TextureHandle Scene::AddTexture(std::unique_ptr<Texture> texture)
 {
-	m_Textures.push_back(std::move(texture));
+	texture->SetLayer(m_TextureArrays.Add(*texture));
+	// The copy in the array is the only one sampled, textures that failed to load keep theirs
+	if (texture->GetLayer().array != TEXTURE_ARRAY_NONE)
+		texture->Release();
+	return m_Resources.GetTextures().Add(std::move(texture));
 }
 
-void Scene::RemoveTexture(size_t toDelete)
+void Scene::RemoveTexture(TextureHandle texture)
 {
-	if (toDelete < m_Textures.size())
-		m_Textures.erase(m_Textures.begin() + toDelete);
-	else
-		std::cerr << "Invalid index. Index is out of range." << std::endl;
+	// Materials still using it keep a stale handle and are drawn without that map
+	m_ResourceVersion++;
+	Texture* removed = m_Resources.GetTextures().Get(texture);
+	if (removed)
+		m_TextureArrays.Remove(removed->GetLayer());
+
+	if (!m_Resources.GetTextures().Remove(texture))
+		std::cerr << "Invalid handle. The texture was already removed." << std::endl;
 }
\ No newline at end of file
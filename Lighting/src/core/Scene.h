@@ -1,61 +1,214 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "Camera.h"
 #include "light/DirectionalLight.hpp"
-#include "light/PointLight.hpp"
-#include "Object.h"
+#include "resource/ResourceRegistry.h"
+#include "ecs/World.h"
+#include "ecs/Components.h"
+#include "ecs/Systems.h"
+#include "jobs/TripleBuffer.h"
+#include "geometry/GeometryBuffer.h"
+#include "render/DrawList.h"
+#include "render/GpuBuffer.h"
+#include "render/MaterialBuffer.h"
+#include "render/RingBuffer.h"
+#include "render/TextureArrayPool.h"
+#include "render/UniformState.h"
 
 #define CAMERA_RES_WIDTH 1920	
 #define CAMERA_RES_HEIGHT 1080
 
+// SSBO bindings, see the buffers of the same name in the shaders
+#define OBJECT_TRANSFORMS_BINDING 0
+#define DRAW_DATA_BINDING 1
+#define MATERIAL_DATA_BINDING 2
+#define POINT_LIGHTS_BINDING 3
+#define LIGHT_INDICES_BINDING 4
+#define CULL_INPUTS_BINDING 5
+#define COMMANDS_BINDING 6
+#define VISIBLE_COMMANDS_BINDING 7
+#define DRAW_COUNTS_BINDING 8
+
+// local_size_x of cull.comp
+#define CULL_GROUP_SIZE 64
+
+// Bytes of geometry moved per frame when compacting the heaps
+#define GEOMETRY_DEFRAGMENT_BUDGET (1024 * 1024)
+
+// Everything the render thread needs to draw a frame, built by the simulation thread
+struct RenderSnapshot
+{
+	std::vector<ObjectTransform> transforms;
+	DrawList drawList;
+	glm::mat4 view;
+	glm::mat4 projection;
+	DirectionalLight dirLight;
+	bool isFlashlightOn;
+	unsigned int resourceVersion;	// Scene::m_ResourceVersion when it was built
+	unsigned int drawListVersion;	// the draw list is only copied when the retained one changed
+
+	RenderSnapshot() : view(1.0f), projection(1.0f), isFlashlightOn(false), resourceVersion(0), drawListVersion(0) {}
+};
+
 class Scene
 {
 public:
 	// Constructor
 	Scene();
+	~Scene();
 
+	// The simulation thread builds frame N+1 while the calling thread draws frame N.
+	// Without it, Draw builds the frame itself.
+	void StartSimulation();
+	void StopSimulation();
+
+	// Draws the latest snapshot, must be called on the thread owning the GL context
 	void Draw();
 	void ToggleFlashlight();
 
-	void AddObject(std::unique_ptr<Object> obj);
-	void RemoveObject(size_t toDelete);
+	// Held by the simulation while it reads the scene, anything editing the scene
+	// (input, UI) must hold it while the simulation is running
+	inline std::mutex& GetMutex() { return m_Mutex; }
+
+	// Entities live in the world and refer to the scene resources by handle
+	Entity CreateObject(const std::string& name, MeshHandle mesh, MaterialHandle material, ShaderHandle shader);
+	Entity CreatePointLight(const std::string& name, MeshHandle mesh, MaterialHandle material, ShaderHandle shader, const glm::vec3& position, const glm::vec3& color);
+	void DestroyEntity(Entity entity);
+
+	// Edits made outside the scene, such as the UI, must be reported for the retained
+	// draw list to see them. Structural changes are swapping a mesh, material or shader
+	// and editing a point light, they rebuild the list.
+	void MarkStructureChanged();
+	void MarkTransformChanged(Entity entity);
 
-	void AddPointLight(std::unique_ptr<PointLight> light);
-	void RemovePointLight(size_t toDelete);
+	// Whether the next frame would differ from the last snapshot built: an edit, the
+	// camera or geometry being compacted. Hold the mutex while the simulation is running.
+	bool HasPendingChanges() const;
 	
-	void AddMesh(std::unique_ptr<Mesh> mesh);
-	void RemoveMesh(size_t toDelete);
+	MeshHandle AddMesh(std::unique_ptr<Mesh> mesh);
+	void RemoveMesh(MeshHandle mesh);
 	
-	void AddShader(std::unique_ptr<Shader> shader);
-	void RemoveShader(size_t toDelete);
+	ShaderHandle AddShader(std::unique_ptr<Shader> shader);
+	void RemoveShader(ShaderHandle shader);
 	
-	void AddMaterial(std::unique_ptr<Material> material);
-	void RemoveMaterial(size_t toDelete);
+	MaterialHandle AddMaterial(std::unique_ptr<Material> material);
+	void RemoveMaterial(MaterialHandle material);
 
-	void AddTexture(std::unique_ptr<Texture> texture);
-	void RemoveTexture(size_t toDelete);
+	TextureHandle AddTexture(std::unique_ptr<Texture> texture);
+	void RemoveTexture(TextureHandle texture);
 
 	inline Camera& GetCamera() { return m_Camera; }
 	inline DirectionalLight& GetDirectionalLight() { return m_DirLight; }
-	inline std::vector<std::unique_ptr<Object>>& GetObjects() { return m_Objects; }
-	inline std::vector<std::unique_ptr<PointLight>>& GetPointLights() { return m_PointLights; }
-	inline std::vector<std::unique_ptr<Mesh>>& GetMeshes() { return m_Meshes; }
-	inline std::vector<std::unique_ptr<Shader>>& GetShaders() { return m_Shaders; }
-	inline std::vector<std::unique_ptr<Material>>& GetMaterials() { return m_Materials; }
-	inline std::vector<std::unique_ptr<Texture>>& GetTextures() { return m_Textures; }
+	inline World& GetWorld() { return m_World; }
+	inline ResourceRegistry& GetResources() { return m_Resources; }
+	inline const MaterialBuffer& GetMaterialBuffer() const { return m_MaterialBuffer; }
+	// Shared uniform blocks sent to programs last frame, and those they already held
+	inline size_t GetUniformUploadCount() const { return m_UniformUploadCount; }
+	inline size_t GetUniformSkipCount() const { return m_UniformSkipCount; }
+	// Since the start: draw list rebuilds, draws patched by transform edits and snapshots not sent as nothing changed
+	inline size_t GetDrawListRebuildCount() const { return m_DrawListRebuildCount; }
+	inline size_t GetPatchedDrawCount() const { return m_PatchedDrawCount; }
+	inline size_t GetSkippedSnapshotCount() const { return m_SkippedSnapshotCount; }
+	inline SlotMap<Mesh>& GetMeshes() { return m_Resources.GetMeshes(); }
+	inline const GeometryBuffer& GetGeometry() const { return m_Geometry; }
+	inline SlotMap<Shader>& GetShaders() { return m_Resources.GetShaders(); }
+	inline SlotMap<Material>& GetMaterials() { return m_Resources.GetMaterials(); }
+	inline SlotMap<Texture>& GetTextures() { return m_Resources.GetTextures(); }
 
 private:
 	Camera m_Camera;
 	DirectionalLight m_DirLight;
-	std::vector<std::unique_ptr<Object>> m_Objects;
-	std::vector<std::unique_ptr<PointLight>> m_PointLights;
-	std::vector<std::unique_ptr<Mesh>> m_Meshes;
-	std::vector<std::unique_ptr<Shader>> m_Shaders;
-	std::vector<std::unique_ptr<Material>> m_Materials;
-	std::vector<std::unique_ptr<Texture>> m_Textures;
+	World m_World;
+	ResourceRegistry m_Resources;
 
 	bool m_IsFlashlightOn;
+
+	// Snapshots point to meshes, materials, shaders and textures. Removing one bumps
+	// the version, snapshots built before are not drawn.
+	unsigned int m_ResourceVersion;
+
+	// Simulation thread and its handoff to the render thread
+	std::mutex m_Mutex;
+	TripleBuffer<RenderSnapshot> m_Snapshots;
+	std::thread m_SimulationThread;
+	std::mutex m_RequestMutex;
+	std::condition_variable m_RequestCondition;
+	bool m_IsSimulating;
+	bool m_IsSnapshotRequested;
+
+	// Retained between snapshots, owned by whichever thread builds them
+	struct RetainedSlot
+	{
+		Entity entity;
+		unsigned int drawIndex;
+	};
+	FrameData m_RetainedFrame;
+	DrawList m_RetainedDrawList;
+	std::vector<RetainedSlot> m_RetainedSlots;			// by entity index
+	std::vector<unsigned int> m_PatchedLights;
+	unsigned int m_DrawListVersion;
+	// What the last snapshot was built from
+	unsigned int m_BuiltStructureVersion;
+	unsigned int m_BuiltResourceVersion;
+	glm::mat4 m_BuiltView;
+	glm::mat4 m_BuiltProjection;
+	DirectionalLight m_BuiltDirLight;
+	bool m_BuiltFlashlight;
+
+	// Edits since the last snapshot
+	unsigned int m_StructureVersion;
+	std::vector<Entity> m_ChangedTransforms;
+
+	size_t m_DrawListRebuildCount;
+	size_t m_PatchedDrawCount;
+	size_t m_SkippedSnapshotCount;
+
+	// Shared vertex and index buffers of every mesh
+	GeometryBuffer m_Geometry;
+	// Texture arrays every texture is copied into, one per size
+	TextureArrayPool m_TextureArrays;
+	bool m_IsDefragmenting;
+	// Bumped when the defragmentation moves meshes, draw lists built before are patched
+	// on the render thread instead of rebuilt
+	unsigned int m_GeometryVersion;
+
+	// Rewritten every frame from the snapshot: transforms, draws, lights and commands
+	RingBuffer m_DynamicBuffer;
+	// One row per material slot, rewritten when a material is edited
+	MaterialBuffer m_MaterialBuffer;
+
+	// GPU culling, it compacts the commands into the visible buffer
+	std::unique_ptr<Shader> m_CullShader;
+	GpuBuffer m_VisibleCommandBuffer;
+	GpuBuffer m_DrawCountBuffer;
+
+	// Uniforms shared by every program and how many block uploads the last frame did or skipped
+	VersionedState<glm::mat4> m_ViewState;
+	VersionedState<DirLightState> m_DirLightState;
+	VersionedState<SpotLightState> m_SpotLightState;
+	size_t m_UniformUploadCount;
+	size_t m_UniformSkipCount;
+
+private:
+	void SimulationLoop();
+	void RequestSnapshot();
+	void BuildSnapshot();
+	bool AcquireSnapshot();
+	void UpdateGeometry();
+	void UpdateSystems(const glm::mat4& view, const glm::mat4& projection, FrameData& frame);
+	void RebuildDrawList(const glm::mat4& view, const glm::mat4& projection);
+	void UpdateTransforms(const glm::mat4& view, const glm::mat4& projection);
+	void PatchChangedTransforms(const glm::mat4& view, const glm::mat4& projection);
+
+	void UploadDrawList(const RenderSnapshot& snapshot);
+	void CullDraws(const RenderSnapshot& snapshot);
+	void UpdateUniformStates(const RenderSnapshot& snapshot);
+	void BindFrameUniforms(Shader* shader);
+	void BindGroupTextures(const DrawGroup& group);
 };
\ No newline at end of file
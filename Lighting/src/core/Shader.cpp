@@ -1,146 +1,428 @@
 #include "Shader.h"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
-{
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+#include "resource/GpuDeletionQueue.h"
+#include "resource/ProgramCache.h"
+#include "ShaderManager.h"
 
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+#include <vector>
+
+static std::string ReadFile(const char* path)
+{
+    std::ifstream file;
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try
     {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
+        file.open(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        file.close();
+        return stream.str();
+    }
+    catch (std::ifstream::failure e)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+    }
+    return std::string();
+}
 
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+// Compiled by compile_spirv.bat next to the sources: res/shaders/spirv/default.frag.spv
+static std::string GetSpirvPath(const char* path)
+{
+    std::string source(path);
+    size_t slash = source.find_last_of("/\\");
+    size_t name = slash != std::string::npos ? slash + 1 : 0;
+    return source.substr(0, name) + "spirv/" + source.substr(name) + ".spv";
+}
 
-        vShaderFile.close();
-        fShaderFile.close();
+// Empty when the file does not exist, the GLSL is used then
+static std::string ReadBinaryFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return std::string();
 
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    } 
-    catch (std::ifstream::failure e)
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+// Issues the compiles and the link without asking for their status, asking would wait
+// for the driver. A cached binary replaces both.
+static Shader::PendingProgram BeginProgram(const std::string* sources, const GLenum* types, const char* const* stageNames, size_t count)
+{
+    Shader::PendingProgram pending = {};
+    ProgramCache& cache = ProgramCache::Get();
+    pending.key = cache.MakeKey(sources, count);
+    pending.program = cache.Load(pending.key);
+    if (pending.program != 0)
     {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+        pending.cached = true;
+        return pending;
     }
 
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+    pending.program = glCreateProgram();
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* code = sources[i].c_str();
+        pending.stages[i] = glCreateShader(types[i]);
+        pending.stageNames[i] = stageNames[i];
+        glShaderSource(pending.stages[i], 1, &code, NULL);
+        glCompileShader(pending.stages[i]);
+        glAttachShader(pending.program, pending.stages[i]);
+    }
+    pending.stageCount = count;
 
-    unsigned int vertex, fragment;
-    int success;
-    char infoLog[512];
+    // Lets ProgramCache read the binary back
+    glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pending.program);
+    return pending;
+}
 
-    // Vertex Shader compilation
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
+// Same with SPIR-V modules, the features become specialization constants instead of
+// defines. The GLSL sources tell which constants each module declares. Returns an
+// empty program when a module does not specialize, the caller then falls back to GLSL.
+static Shader::PendingProgram BeginSpirvProgram(const std::string* binaries, const std::string* sources, const GLenum* types,
+    const char* const* stageNames, size_t count, unsigned int features)
+{
+    std::vector<std::string> keySources(binaries, binaries + count);
+    keySources.push_back("SPIR-V " + std::to_string(features));
 
-    // Checking for successful compilation
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success)
+    Shader::PendingProgram pending = {};
+    ProgramCache& cache = ProgramCache::Get();
+    pending.key = cache.MakeKey(keySources.data(), keySources.size());
+    pending.program = cache.Load(pending.key);
+    if (pending.program != 0)
+    {
+        pending.cached = true;
+        return pending;
+    }
+
+    unsigned int stages[2];
+    for (size_t i = 0; i < count; i++)
     {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        // Only the constants the module declares, the others would fail the specialization
+        std::vector<GLuint> indices;
+        std::vector<GLuint> values;
+        for (size_t feature = 0; feature < sizeof(s_ShaderFeatures) / sizeof(s_ShaderFeatures[0]); feature++)
+        {
+            if (sources[i].find(s_ShaderFeatures[feature].constant) == std::string::npos)
+                continue;
+            indices.push_back(static_cast<GLuint>(feature));
+            values.push_back((features & s_ShaderFeatures[feature].bit) ? 1 : 0);
+        }
+        if (sources[i].find("MAX_POINT_LIGHTS") != std::string::npos)
+        {
+            indices.push_back(SHADER_CONSTANT_MAX_POINT_LIGHTS);
+            values.push_back(SHADER_MAX_POINT_LIGHTS);
+        }
+
+        stages[i] = glCreateShader(types[i]);
+        glShaderBinary(1, &stages[i], GL_SHADER_BINARY_FORMAT_SPIR_V, binaries[i].data(), static_cast<GLsizei>(binaries[i].size()));
+        glSpecializeShader(stages[i], "main", static_cast<GLuint>(indices.size()), indices.data(), values.data());
+
+        int success;
+        glGetShaderiv(stages[i], GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            char infoLog[512];
+            glGetShaderInfoLog(stages[i], 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::" << stageNames[i] << "::SPECIALIZATION_FAILED\n" << infoLog << std::endl;
+            for (size_t j = 0; j <= i; j++)
+                glDeleteShader(stages[j]);
+            return Shader::PendingProgram();
+        }
     }
 
-    // Fragment Shader compilation
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
+    pending.program = glCreateProgram();
+    for (size_t i = 0; i < count; i++)
+    {
+        pending.stages[i] = stages[i];
+        pending.stageNames[i] = stageNames[i];
+        glAttachShader(pending.program, stages[i]);
+    }
+    pending.stageCount = count;
 
-    // Checking for successful compilation
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
+    glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pending.program);
+    return pending;
+}
+
+// Whether every uniform outside a block can be found by name. The setters look them up
+// that way, and some drivers return -1 for SPIR-V programs even with debug names.
+static bool HasUniformLocations(unsigned int program)
+{
+    int count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (int i = 0; i < count; i++)
     {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        GLuint index = static_cast<GLuint>(i);
+        int block;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+        if (block != -1)
+            continue;
+
+        char name[256];
+        GLsizei length = 0;
+        glGetActiveUniformName(program, index, sizeof(name), &length, name);
+        if (length == 0 || glGetUniformLocation(program, name) == -1)
+            return false;
     }
+    return true;
+}
 
-    // Linking shaders
-    program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
+// Reports the errors and saves the binary, blocks if the driver is still busy
+static unsigned int FinishProgram(Shader::PendingProgram& pending)
+{
+    int success;
+    char infoLog[512];
+
+    // Checking for successful compilation
+    for (size_t i = 0; i < pending.stageCount; i++)
+    {
+        glGetShaderiv(pending.stages[i], GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(pending.stages[i], 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::" << pending.stageNames[i] << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        glDeleteShader(pending.stages[i]);
+    }
 
     // Checking for linking errors
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    glGetProgramiv(pending.program, GL_LINK_STATUS, &success);
     if (!success)
     {
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        glGetProgramInfoLog(pending.program, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
     }
+    else if (pending.spirv && !HasUniformLocations(pending.program))
+    {
+        // Never used, nothing in flight references it. Not saved, so the next run checks again
+        glDeleteProgram(pending.program);
+        pending = {};
+        return 0;
+    }
+    else if (!pending.cached)
+    {
+        ProgramCache::Get().Save(pending.key, pending.program);
+    }
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    unsigned int program = pending.program;
+    pending = {};
+    return program;
 }
 
-void Shader::Use() const
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
-    glUseProgram(program);
+    m_VertexSource = ReadFile(vertexPath);
+    m_FragmentSource = ReadFile(fragmentPath);
+    m_SupportedFeatures = FindShaderFeatures(m_VertexSource) | FindShaderFeatures(m_FragmentSource);
+
+#if SHADER_USE_SPIRV
+    // Both stages or none, a program cannot mix SPIR-V and GLSL shaders
+    if (glSpecializeShader)
+    {
+        m_VertexSpirv = ReadBinaryFile(GetSpirvPath(vertexPath));
+        m_FragmentSpirv = ReadBinaryFile(GetSpirvPath(fragmentPath));
+        if (m_VertexSpirv.empty() || m_FragmentSpirv.empty())
+        {
+            m_VertexSpirv.clear();
+            m_FragmentSpirv.clear();
+        }
+    }
+#endif
+
+    // The variant without features is built in the background, the others on first use
+    m_Pending = Begin(0);
+    program = m_Pending.program;
+    m_Variants[0] = program;
+    m_Active = program;
+    ShaderManager::Get().Track(this);
+}
+
+Shader::Shader(const char* computePath) :
+    m_SupportedFeatures(0)
+{
+    std::string computeSource = ReadFile(computePath);
+    const GLenum type = GL_COMPUTE_SHADER;
+    const char* stageName = "COMPUTE";
+
+    m_Pending = BeginProgram(&computeSource, &type, &stageName, 1);
+    program = m_Pending.program;
+    m_Variants[0] = program;
+    m_Active = program;
+    ShaderManager::Get().Track(this);
+}
+
+Shader::~Shader()
+{
+    ShaderManager::Get().Untrack(this);
+    for (size_t i = 0; i < m_Pending.stageCount; i++)
+        glDeleteShader(m_Pending.stages[i]);
+
+    for (const auto& variant : m_Variants)
+        GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::PROGRAM, variant.second);
+}
+
+void Shader::Use(unsigned int features) const
+{
+    // Drawing cannot wait any longer for the background link
+    if (m_Pending.program != 0)
+        FinishPending();
+
+    features &= m_SupportedFeatures;
+
+    auto it = m_Variants.find(features);
+    if (it == m_Variants.end())
+    {
+        PendingProgram pending = Begin(features);
+        it = m_Variants.emplace(features, Finish(pending)).first;
+    }
+
+    m_Active = it->second;
+    glUseProgram(m_Active);
+}
+
+bool Shader::IsReady() const
+{
+    if (m_Pending.program == 0)
+        return true;
+    if (!ShaderManager::Get().IsComplete(m_Pending.program))
+        return false;
+
+    FinishPending();
+    return true;
+}
+
+bool Shader::ShouldUpload(unsigned int block, unsigned int version) const
+{
+    auto it = m_BlockVersions.find(m_Active);
+    if (it == m_BlockVersions.end())
+    {
+        std::array<unsigned int, SHADER_BLOCK_COUNT> versions = {};
+        it = m_BlockVersions.emplace(m_Active, versions).first;
+    }
+
+    if (it->second[block] == version)
+        return false;
+    it->second[block] = version;
+    return true;
+}
+
+Shader::PendingProgram Shader::Begin(unsigned int features) const
+{
+    const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+    const char* stageNames[2] = { "VERTEX", "FRAGMENT" };
+
+    // No front-end work with SPIR-V, one module per stage covers every variant
+    if (!m_VertexSpirv.empty())
+    {
+        const std::string binaries[2] = { m_VertexSpirv, m_FragmentSpirv };
+        const std::string sources[2] = { m_VertexSource, m_FragmentSource };
+        PendingProgram pending = BeginSpirvProgram(binaries, sources, types, stageNames, 2, features);
+        if (pending.program != 0)
+        {
+            pending.spirv = true;
+            pending.features = features;
+            return pending;
+        }
+
+        std::cout << "Falling back to the GLSL sources of " << (m_Name.empty() ? "a shader" : m_Name) << std::endl;
+        m_VertexSpirv.clear();
+        m_FragmentSpirv.clear();
+    }
+
+    // Each variant has its own cache entry, the defines are part of the hashed sources
+    std::string sources[2] = { AddShaderDefines(m_VertexSource, features), AddShaderDefines(m_FragmentSource, features) };
+    return BeginProgram(sources, types, stageNames, 2);
+}
+
+unsigned int Shader::Finish(PendingProgram& pending) const
+{
+    bool spirv = pending.spirv;
+    unsigned int features = pending.features;
+    unsigned int linked = FinishProgram(pending);
+    if (linked != 0 || !spirv)
+        return linked;
+
+    // Only the loose uniforms are at fault, but every variant would hit the same driver
+    std::cout << "Uniforms of the SPIR-V " << (m_Name.empty() ? "shader" : m_Name) << " cannot be set by name, falling back to the GLSL sources" << std::endl;
+    m_VertexSpirv.clear();
+    m_FragmentSpirv.clear();
+
+    PendingProgram glsl = Begin(features);
+    return FinishProgram(glsl);
+}
+
+void Shader::FinishPending() const
+{
+    // The pending program is always the variant without features
+    unsigned int linked = Finish(m_Pending);
+    if (linked == program)
+        return;
+
+    m_Variants[0] = linked;
+    if (m_Active == program)
+        m_Active = linked;
+    program = linked;
 }
 
 unsigned int Shader::GetShaderProgram() const
 {
-    return program;
+    return m_Active;
 }
 
 void Shader::SetBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), (int)value);
+    glUniform1i(glGetUniformLocation(m_Active, name.c_str()), (int)value);
 }
 void Shader::SetInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+    glUniform1i(glGetUniformLocation(m_Active, name.c_str()), value);
 }
 void Shader::SetFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(program, name.c_str()), value);
+    glUniform1f(glGetUniformLocation(m_Active, name.c_str()), value);
 }
 
 void Shader::SetVec2(const std::string& name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+    glUniform2fv(glGetUniformLocation(m_Active, name.c_str()), 1, &value[0]);
 }
 void Shader::SetVec2(const std::string& name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(program, name.c_str()), x, y);
+    glUniform2f(glGetUniformLocation(m_Active, name.c_str()), x, y);
 }
 
 void Shader::SetVec3(const std::string& name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+    glUniform3fv(glGetUniformLocation(m_Active, name.c_str()), 1, &value[0]);
 }
 void Shader::SetVec3(const std::string& name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(program, name.c_str()), x, y, z);
+    glUniform3f(glGetUniformLocation(m_Active, name.c_str()), x, y, z);
 }
 
 void Shader::SetVec4(const std::string& name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(program, name.c_str()), 1, &value[0]);
+    glUniform4fv(glGetUniformLocation(m_Active, name.c_str()), 1, &value[0]);
 }
 void Shader::SetVec4(const std::string& name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(program, name.c_str()), x, y, z, w);
+    glUniform4f(glGetUniformLocation(m_Active, name.c_str()), x, y, z, w);
 }
 
 void Shader::SetMat2(const std::string& name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(glGetUniformLocation(m_Active, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetMat3(const std::string& name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(glGetUniformLocation(m_Active, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::SetMat4(const std::string& name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(m_Active, name.c_str()), 1, GL_FALSE, &mat[0][0]);
 }
\ No newline at end of file
@@ -5,19 +5,66 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+
+#include "ShaderFeatures.h"
+
+// Uniform blocks every program reads, re-uploaded only when their version changes
+#define SHADER_BLOCK_VIEW			0
+#define SHADER_BLOCK_DIR_LIGHT		1
+#define SHADER_BLOCK_SPOT_LIGHT		2
+#define SHADER_BLOCK_COUNT			3
+
+// Load res/shaders/spirv/<file>.spv when compile_spirv.bat has produced it, 0 always
+// compiles the GLSL
+#define SHADER_USE_SPIRV 1
 
 class Shader
 {
 	public:
+		// Compiles and link issued to the driver, checked once it is done with them
+		struct PendingProgram
+		{
+			unsigned int program;	// 0 when nothing is pending
+			unsigned int stages[2];
+			const char* stageNames[2];
+			size_t stageCount;
+			uint64_t key;			// ProgramCache entry
+			bool cached;			// loaded from a binary, nothing to compile
+			bool spirv;
+			unsigned int features;
+		};
+
+	public:
+		// Both constructors only issue the work, see ShaderManager
 		Shader(const char* vertexPath, const char* fragmentPath);
+		// Compute program
+		explicit Shader(const char* computePath);
+		~Shader();
 		
-		void Use() const;
+		// Binds the variant compiled with the given features, compiling it on first use.
+		// Features the sources do not test are ignored, so they do not create duplicates.
+		// The setters below apply to the variant bound last.
+		void Use(unsigned int features = 0) const;
+
+		// Whether the program is linked, finishes it if so. Never waits for the driver
+		// with KHR_parallel_shader_compile, without it the first call blocks.
+		bool IsReady() const;
+
+		// Whether the bound variant has not received this version of the block yet,
+		// records it as received
+		bool ShouldUpload(unsigned int block, unsigned int version) const;
 		
 		unsigned int GetShaderProgram() const;
+		inline unsigned int GetSupportedFeatures() const { return m_SupportedFeatures; }
+		inline size_t GetVariantCount() const { return m_Variants.size(); }
 
 		void SetBool(const std::string& name, bool value) const;
 		void SetInt(const std::string& name, int value) const;
@@ -40,6 +87,22 @@ class Shader
 		inline const std::string& GetName() const { return m_Name; }
 
 	private:
-		unsigned int program;
+		mutable unsigned int program;	// variant without features, replaced if the SPIR-V falls back
 		std::string m_Name;
+
+		std::string m_VertexSource;
+		std::string m_FragmentSource;
+		mutable std::string m_VertexSpirv;		// empty when the GLSL is compiled
+		mutable std::string m_FragmentSpirv;
+		unsigned int m_SupportedFeatures;
+		mutable std::unordered_map<unsigned int, unsigned int> m_Variants;	// features to program
+		mutable unsigned int m_Active;
+		mutable PendingProgram m_Pending;
+		// Program to the block versions it holds, programs keep their uniforms
+		mutable std::unordered_map<unsigned int, std::array<unsigned int, SHADER_BLOCK_COUNT>> m_BlockVersions;
+
+		PendingProgram Begin(unsigned int features) const;
+		// FinishProgram, rebuilding from the GLSL when the SPIR-V cannot be used
+		unsigned int Finish(PendingProgram& pending) const;
+		void FinishPending() const;
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+
+// Header only, the asset cooker includes it to validate the sources the way Shader compiles them
+
+// Feature bits of a shader variant. The sources test them as FEATURE_<name> constants:
+// defines added to the GLSL, specialization constants in the SPIR-V, the bit index
+// being the constant id. A shader supports the features its sources mention.
+#define SHADER_FEATURE_TEXTURED		(1u << 0)
+#define SHADER_FEATURE_FLASHLIGHT	(1u << 1)
+#define SHADER_FEATURE_EMISSION		(1u << 2)
+#define SHADER_FEATURE_POINT_LIGHTS	(1u << 3)
+
+// Point lights per draw, MAX_POINT_LIGHTS in the shaders
+#define SHADER_MAX_POINT_LIGHTS 128
+#define SHADER_CONSTANT_MAX_POINT_LIGHTS 4
+
+struct ShaderFeature
+{
+	unsigned int bit;
+	const char* constant;
+};
+
+// In constant id order
+static const ShaderFeature s_ShaderFeatures[] =
+{
+	{ SHADER_FEATURE_TEXTURED, "FEATURE_TEXTURED" },
+	{ SHADER_FEATURE_FLASHLIGHT, "FEATURE_FLASHLIGHT" },
+	{ SHADER_FEATURE_EMISSION, "FEATURE_EMISSION" },
+	{ SHADER_FEATURE_POINT_LIGHTS, "FEATURE_POINT_LIGHTS" },
+};
+
+// Features the source tests
+inline unsigned int FindShaderFeatures(const std::string& source)
+{
+	unsigned int features = 0;
+	for (const ShaderFeature& feature : s_ShaderFeatures)
+	{
+		if (source.find(feature.constant) != std::string::npos)
+			features |= feature.bit;
+	}
+	return features;
+}
+
+// The defines have to come after #version, #line keeps the error messages pointing at the file
+inline std::string AddShaderDefines(const std::string& source, unsigned int features)
+{
+	size_t version = source.find("#version");
+	size_t lineEnd = version != std::string::npos ? source.find('\n', version) : std::string::npos;
+	if (lineEnd == std::string::npos)
+		return source;
+
+	std::string defines;
+	for (const ShaderFeature& feature : s_ShaderFeatures)
+		defines += std::string("#define ") + feature.constant + ((features & feature.bit) ? " true\n" : " false\n");
+	defines += "#define MAX_POINT_LIGHTS " + std::to_string(SHADER_MAX_POINT_LIGHTS) + "u\n";
+
+	int line = 2;
+	for (size_t i = 0; i < lineEnd; i++)
+		line += source[i] == '\n';
+
+	return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(line) + "\n" + source.substr(lineEnd + 1);
+}
@@ -0,0 +1,70 @@
+#include "ShaderManager.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include "Shader.h"
+
+// Not in the glad build, the ARB extension shares the values
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+ShaderManager& ShaderManager::Get()
+{
+	// Never destroyed: shaders owned by globals untrack themselves during static destruction
+	static ShaderManager* instance = new ShaderManager();
+	return *instance;
+}
+
+void ShaderManager::Initialize()
+{
+	MaxShaderCompilerThreadsProc maxThreads = nullptr;
+	if (glfwExtensionSupported("GL_KHR_parallel_shader_compile"))
+		maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+	else if (glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+		maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+
+	m_IsParallel = maxThreads != nullptr;
+	if (!m_IsParallel)
+	{
+		std::cout << "Parallel shader compilation unavailable, shaders are linked one after the other" << std::endl;
+		return;
+	}
+
+	// As many threads as the driver wants
+	maxThreads(0xFFFFFFFF);
+
+	GLint threads = 0;
+	glGetIntegerv(GL_MAX_SHADER_COMPILER_THREADS_KHR, &threads);
+	std::cout << "Parallel shader compilation on " << threads << " driver threads" << std::endl;
+}
+
+void ShaderManager::Track(Shader* shader)
+{
+	m_Pending.push_back(shader);
+}
+
+void ShaderManager::Untrack(Shader* shader)
+{
+	m_Pending.erase(std::remove(m_Pending.begin(), m_Pending.end(), shader), m_Pending.end());
+}
+
+size_t ShaderManager::Update()
+{
+	// Without the extension each IsReady waits for its program
+	m_Pending.erase(std::remove_if(m_Pending.begin(), m_Pending.end(),
+		[](Shader* shader) { return shader->IsReady(); }), m_Pending.end());
+	return m_Pending.size();
+}
+
+bool ShaderManager::IsComplete(unsigned int program) const
+{
+	if (!m_IsParallel)
+		return true;
+
+	GLint complete = GL_FALSE;
+	glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete == GL_TRUE;
+}
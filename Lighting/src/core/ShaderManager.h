@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+class Shader;
+
+// Keeps track of the shaders whose programs are still compiling. With
+// KHR_parallel_shader_compile the driver compiles them on its own threads and the
+// completion status is polled, so startup goes on while they build.
+class ShaderManager
+{
+public:
+	static ShaderManager& Get();
+
+	// Once the GL functions are loaded, before any shader is created
+	void Initialize();
+
+	// Registered by the shaders themselves
+	void Track(Shader* shader);
+	void Untrack(Shader* shader);
+
+	// Finishes the shaders the driver is done with, returns how many are still compiling
+	size_t Update();
+
+	// Whether the link issued for the program is done, always true without the extension
+	bool IsComplete(unsigned int program) const;
+	inline bool IsParallel() const { return m_IsParallel; }
+	inline size_t GetPendingCount() const { return m_Pending.size(); }
+
+private:
+	typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+	bool m_IsParallel;
+	std::vector<Shader*> m_Pending;
+
+private:
+	ShaderManager() : m_IsParallel(false) {}
+	ShaderManager(const ShaderManager&) = delete;
+	ShaderManager& operator=(const ShaderManager&) = delete;
+};
@@ -1,13 +1,15 @@
 #include "Texture.h"
 
 #include <stb_image/stb_image.h>
+#include "resource/GpuDeletionQueue.h"
 
 Texture::Texture(std::string path) :
 	Texture(path, 0, GL_REPEAT, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR)
 {
 }
 
-Texture::Texture(std::string path, int levelOfDetail, GLint wrapS, GLint wrapT, GLint minFilter, GLint magFilter)
+Texture::Texture(std::string path, int levelOfDetail, GLint wrapS, GLint wrapT, GLint minFilter, GLint magFilter) :
+	width(0), height(0)
 {
 	// create texture
 	CreateTexture(wrapS, wrapT, minFilter, magFilter);
@@ -29,6 +31,11 @@ Texture::Texture(std::string path, int levelOfDetail, GLint wrapS, GLint wrapT,
 	Unbind();
 }
 
+Texture::~Texture()
+{
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::TEXTURE, texture);
+}
+
 void Texture::Bind() const
 {
 	glBindTexture(GL_TEXTURE_2D, texture);
@@ -44,15 +51,30 @@ unsigned int Texture::GetTexture() const
 	return texture;
 }
 
+void Texture::Release()
+{
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::TEXTURE, texture);
+	texture = 0;
+}
+
+int Texture::GetLevelCount() const
+{
+	int levels = 1;
+	for (int size = width > height ? width : height; size > 1; size >>= 1)
+		levels++;
+	return levels;
+}
+
 void Texture::LoadFromFile(std::string path, int levelOfDetail, GLenum format)
 {
-	int width, height, nrChannels;
+	int nrChannels;
 	stbi_set_flip_vertically_on_load(true);
 	unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
 
 	if (data)
 	{
-		glTexImage2D(GL_TEXTURE_2D, levelOfDetail, GL_RGB, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		// Sized, glCopyImageSubData into the texture arrays needs matching formats
+		glTexImage2D(GL_TEXTURE_2D, levelOfDetail, GL_RGB8, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 	}
 	else
@@ -3,6 +3,17 @@
 #include <glad/glad.h>
 #include <iostream>
 
+#define TEXTURE_ARRAY_NONE 0xFFFFFFFF
+
+// Where a texture lives in the TextureArrayPool
+struct TextureLayer
+{
+	unsigned int array;		// TEXTURE_ARRAY_NONE when the texture is not pooled
+	unsigned int layer;
+
+	TextureLayer() : array(TEXTURE_ARRAY_NONE), layer(0) {}
+};
+
 class Texture
 {
 public:
@@ -15,11 +26,25 @@ public:
 		GLint minFilter,
 		GLint magFilter
 	);
+	~Texture();
 
 	void Bind() const;
 	void Unbind() const;
 
+	// 0 once released
 	unsigned int GetTexture() const;
+	inline int GetWidth() const { return width; }
+	inline int GetHeight() const { return height; }
+	// Mip levels of the full chain generated on load
+	int GetLevelCount() const;
+
+	// Set by the scene when the texture is copied into its texture array
+	void SetLayer(const TextureLayer& textureLayer) { layer = textureLayer; }
+	inline const TextureLayer& GetLayer() const { return layer; }
+
+	// Hands the GL_TEXTURE_2D to the deletion queue once its pixels live in a texture
+	// array, only the layer and the size are kept
+	void Release();
 
 private:
 
@@ -32,6 +57,9 @@ private:
 
 	unsigned int texture;
 	Format format;
+	int width;
+	int height;
+	TextureLayer layer;
 
 private:
 	void LoadFromFile(std::string path, int levelOfDetail, GLenum format);
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "../resource/Handle.h"
+
+struct NameComponent
+{
+	std::string name;
+
+	explicit NameComponent(const std::string& name) : name(name) {}
+};
+
+struct TransformComponent
+{
+	glm::vec3 position;
+	glm::vec3 rotation;			// Euler angles in degrees, as edited in the UI
+	glm::quat orientation;		// Same rotation, what the systems use
+	glm::vec3 scale;
+	bool isUniformScaling;
+
+	TransformComponent(const glm::vec3& position = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f)) :
+		position(position), rotation(0.0f), orientation(1.0f, 0.0f, 0.0f, 0.0f), scale(scale), isUniformScaling(true)
+	{
+	}
+
+	void SetRotation(const glm::vec3& eulerDegrees)
+	{
+		rotation = eulerDegrees;
+		orientation =
+			glm::angleAxis(glm::radians(eulerDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
+			glm::angleAxis(glm::radians(eulerDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::angleAxis(glm::radians(eulerDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	}
+};
+
+struct MeshRendererComponent
+{
+	MeshHandle mesh;
+	MaterialHandle material;
+	ShaderHandle shader;
+
+	// Written by the culling system every frame
+	bool isVisible;
+
+	MeshRendererComponent(MeshHandle mesh, MaterialHandle material, ShaderHandle shader) :
+		mesh(mesh), material(material), shader(shader),
+		isVisible(true)
+	{
+	}
+};
+
+struct PointLightComponent
+{
+	glm::vec3 color;
+	float radius;
+	float intensity;
+
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+
+	explicit PointLightComponent(const glm::vec3& color = glm::vec3(1.0f), float radius = 5.0f) :
+		color(color), radius(radius), intensity(1.0f),
+		ambient(0.2f * color), diffuse(0.5f * color), specular(color)
+	{
+	}
+};
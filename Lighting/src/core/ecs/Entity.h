@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Stable handle to an entity. The generation is bumped every time the index is
+// recycled, so handles to destroyed entities never resolve to a new one.
+struct Entity
+{
+	uint32_t index;
+	uint32_t generation;
+
+	static const uint32_t INVALID_INDEX = ~0u;
+
+	Entity() : index(INVALID_INDEX), generation(0) {}
+	Entity(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+	inline bool IsValid() const { return index != INVALID_INDEX; }
+
+	inline bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	inline bool operator!=(const Entity& other) const { return !(*this == other); }
+};
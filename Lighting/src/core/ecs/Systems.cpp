@@ -0,0 +1,248 @@
+#include "Systems.h"
+
+#include <algorithm>
+#include <functional>
+
+// Shader side limit, the MAX_POINT_LIGHTS constant of the shaders
+#define MAX_LIGHTS_PER_OBJECT SHADER_MAX_POINT_LIGHTS
+
+// Smallest number of entities or render items handed to one job
+#define SYSTEM_MIN_BATCH_SIZE 64
+
+// Creates a job that starts once after has finished and runs it
+static Job* ScheduleAfter(std::function<void()> function, Job* after)
+{
+	JobSystem& jobs = JobSystem::Get();
+	Job* job = jobs.Create(std::move(function));
+	if (after)
+		jobs.AddDependency(job, after);
+	jobs.Run(job);
+	return job;
+}
+
+glm::vec4 GetBounds(const Mesh* mesh, const TransformComponent& transform)
+{
+	float maxScale = std::max(std::abs(transform.scale.x), std::max(std::abs(transform.scale.y), std::abs(transform.scale.z)));
+	return glm::vec4(transform.position, mesh->GetBoundingRadius() * maxScale);
+}
+
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	// Gribb/Hartmann: each plane is the last row plus or minus one of the others
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++)
+		rows[r] = glm::vec4(viewProjection[0][r], viewProjection[1][r], viewProjection[2][r], viewProjection[3][r]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (auto& plane : frustum.planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return frustum;
+}
+
+Job* CullingSystem::Schedule(World& world, const ResourceRegistry& resources, Job* after)
+{
+	JobSystem& jobs = JobSystem::Get();
+	Job* root = jobs.Create(nullptr);
+	root->function = [&jobs, root, &world, &resources]()
+	{
+		// Entities are independent, each chunk is split in batches
+		world.ForEachChunk<MeshRendererComponent>(
+			[&jobs, root, &resources](size_t count, const Entity*, MeshRendererComponent* renderers)
+		{
+			jobs.RunBatches(root, count, SYSTEM_MIN_BATCH_SIZE, [&resources, renderers](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					MeshRendererComponent& renderer = renderers[i];
+					renderer.isVisible = resources.Get(renderer.mesh) && resources.Get(renderer.material) && resources.Get(renderer.shader);
+				}
+			});
+		});
+	};
+
+	if (after)
+		jobs.AddDependency(root, after);
+	jobs.Run(root);
+	return root;
+}
+
+Job* RenderExtractionSystem::Schedule(World& world, const ResourceRegistry& resources, FrameData& frame, Job* after)
+{
+	// Sequential, it only copies what the other systems then work on in parallel
+	return ScheduleAfter([&world, &resources, &frame]()
+	{
+		frame.transformInputs.Clear();
+		frame.renderItems.clear();
+		frame.pointLights.clear();
+
+		world.ForEachChunk<TransformComponent, PointLightComponent>(
+			[&frame](size_t count, const Entity*, TransformComponent* transforms, PointLightComponent* lights)
+		{
+			for (size_t i = 0; i < count; i++)
+				frame.pointLights.push_back({ transforms[i].position, lights[i].radius, lights[i].ambient, lights[i].diffuse, lights[i].specular });
+		});
+
+		world.ForEachChunk<TransformComponent, MeshRendererComponent>(
+			[&resources, &frame](size_t count, const Entity* entities, TransformComponent* transforms, MeshRendererComponent* renderers)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const MeshRendererComponent& renderer = renderers[i];
+				if (!renderer.isVisible)
+					continue;
+
+				Mesh* mesh = resources.Get(renderer.mesh);
+				glm::vec4 bounds = GetBounds(mesh, transforms[i]);
+				frame.renderItems.push_back({ mesh, resources.Get(renderer.material), resources.Get(renderer.shader), renderer.material.index,
+					static_cast<unsigned int>(frame.transformInputs.GetCount()), bounds, nullptr, 0, false, glm::vec3(0.0f), entities[i] });
+				frame.transformInputs.Add(transforms[i].position, transforms[i].orientation, transforms[i].scale);
+			}
+		}, World::MaskOf<PointLightComponent>());
+
+		// Light entities are emissive and do not receive light
+		world.ForEachChunk<TransformComponent, MeshRendererComponent, PointLightComponent>(
+			[&resources, &frame](size_t count, const Entity* entities, TransformComponent* transforms, MeshRendererComponent* renderers, PointLightComponent* lights)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				const MeshRendererComponent& renderer = renderers[i];
+				if (!renderer.isVisible)
+					continue;
+
+				Mesh* mesh = resources.Get(renderer.mesh);
+				glm::vec4 bounds = GetBounds(mesh, transforms[i]);
+				frame.renderItems.push_back({ mesh, resources.Get(renderer.material), resources.Get(renderer.shader), renderer.material.index,
+					static_cast<unsigned int>(frame.transformInputs.GetCount()), bounds, nullptr, 0, true, lights[i].intensity * lights[i].color, entities[i] });
+				frame.transformInputs.Add(transforms[i].position, transforms[i].orientation, transforms[i].scale);
+			}
+		});
+	}, after);
+}
+
+Job* RenderExtractionSystem::ScheduleSort(const ResourceRegistry& resources, FrameData& frame, Job* after)
+{
+	return ScheduleAfter([&resources, &frame]()
+	{
+		// Items sharing a program and texture arrays end up next to each other and are
+		// drawn with one multi-draw, see DrawList
+		std::sort(frame.renderItems.begin(), frame.renderItems.end(), [&resources](const RenderItem& a, const RenderItem& b)
+		{
+			if (a.shader != b.shader)
+				return a.shader < b.shader;
+			if (a.isLight != b.isLight)
+				return a.isLight < b.isLight;
+
+			unsigned int arraysA[3] = { resources.GetTextureLayer(a.material->GetDiffuseMap()).array,
+				resources.GetTextureLayer(a.material->GetSpecularMap()).array, resources.GetTextureLayer(a.material->GetEmissionMap()).array };
+			unsigned int arraysB[3] = { resources.GetTextureLayer(b.material->GetDiffuseMap()).array,
+				resources.GetTextureLayer(b.material->GetSpecularMap()).array, resources.GetTextureLayer(b.material->GetEmissionMap()).array };
+			for (int i = 0; i < 3; i++)
+			{
+				if (arraysA[i] != arraysB[i])
+					return arraysA[i] < arraysB[i];
+			}
+
+			if (a.material != b.material)
+				return a.material < b.material;
+			return a.mesh < b.mesh;
+		});
+	}, after);
+}
+
+Job* TransformSystem::Schedule(const glm::mat4& view, const glm::mat4& projection, FrameData& frame, Job* after)
+{
+	JobSystem& jobs = JobSystem::Get();
+	Job* root = jobs.Create(nullptr);
+	root->function = [&jobs, root, view, projection, &frame]()
+	{
+		size_t count = frame.transformInputs.GetCount();
+		frame.transforms.resize(count);
+
+		ObjectTransform* outputs = frame.transforms.data();
+		jobs.RunBatches(root, count, SYSTEM_MIN_BATCH_SIZE, [&frame, view, projection, outputs](size_t begin, size_t end)
+		{
+			BatchTransform::ComputeRange(frame.transformInputs, view, projection, outputs, begin, end);
+		});
+	};
+
+	if (after)
+		jobs.AddDependency(root, after);
+	jobs.Run(root);
+	return root;
+}
+
+Job* LightAssignmentSystem::Schedule(FrameData& frame, Job* after)
+{
+	JobSystem& jobs = JobSystem::Get();
+	Job* root = jobs.Create(nullptr);
+	root->function = [&jobs, root, &frame]()
+	{
+		size_t count = frame.renderItems.size();
+		size_t batchSize = jobs.GetBatchSize(count, SYSTEM_MIN_BATCH_SIZE);
+
+		// Each batch owns a list, so no two jobs append to the same vector.
+		// Lists are only grown, they keep their capacity from one frame to the next.
+		size_t batchCount = (count + batchSize - 1) / batchSize;
+		if (frame.lightBatches.size() < batchCount)
+			frame.lightBatches.resize(batchCount);
+
+		jobs.RunBatches(root, count, SYSTEM_MIN_BATCH_SIZE, [&frame, batchSize](size_t begin, size_t end)
+		{
+			const std::vector<PointLightData>& pointLights = frame.pointLights;
+			std::vector<unsigned int>& indices = frame.lightBatches[begin / batchSize];
+			indices.clear();
+
+			// The items point into the list, it must not reallocate while it is filled
+			size_t maxIndices = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				if (!frame.renderItems[i].isLight)
+					maxIndices += std::min<size_t>(pointLights.size(), MAX_LIGHTS_PER_OBJECT);
+			}
+			indices.reserve(maxIndices);
+
+			for (size_t i = begin; i < end; i++)
+			{
+				RenderItem& item = frame.renderItems[i];
+				item.lights = indices.data() + indices.size();
+				item.lightCount = 0;
+
+				if (item.isLight)
+					continue;
+
+				item.lightCount = Assign(item.bounds, pointLights, indices);
+			}
+		});
+	};
+
+	if (after)
+		jobs.AddDependency(root, after);
+	jobs.Run(root);
+	return root;
+}
+
+unsigned int LightAssignmentSystem::Assign(const glm::vec4& bounds, const std::vector<PointLightData>& pointLights, std::vector<unsigned int>& indices)
+{
+	unsigned int count = 0;
+	glm::vec3 center(bounds);
+	for (unsigned int light = 0; light < pointLights.size() && count < MAX_LIGHTS_PER_OBJECT; light++)
+	{
+		float reach = bounds.w + pointLights[light].radius;
+		glm::vec3 offset = pointLights[light].position - center;
+		if (glm::dot(offset, offset) <= reach * reach)
+		{
+			indices.push_back(light);
+			count++;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "World.h"
+#include "Components.h"
+#include "../transform/BatchTransform.h"
+#include "../resource/ResourceRegistry.h"
+#include "../jobs/JobSystem.h"
+
+// Point light as uploaded to the shaders, position in world space
+struct PointLightData
+{
+	glm::vec3 position;
+	float radius;
+
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+};
+
+// One draw with its resources resolved, everything the renderer needs without going back to the world
+struct RenderItem
+{
+	Mesh* mesh;
+	Material* material;
+	Shader* shader;
+	unsigned int materialIndex;		// slot of the material, its row in the material buffer
+	unsigned int transformIndex;
+	glm::vec4 bounds;				// world space bounding sphere, xyz center and w radius
+	const unsigned int* lights;		// indices in FrameData::pointLights
+	unsigned int lightCount;
+	bool isLight;
+	glm::vec3 color;				// emissive color of light entities
+	Entity entity;
+};
+
+// Output of the systems for one frame, reused between frames to avoid allocations
+struct FrameData
+{
+	TransformInputs transformInputs;
+	std::vector<ObjectTransform> transforms;
+	std::vector<PointLightData> pointLights;
+	std::vector<std::vector<unsigned int>> lightBatches;	// light indices, one list per assignment batch
+	std::vector<RenderItem> renderItems;
+};
+
+struct Frustum
+{
+	glm::vec4 planes[6];
+
+	// Normalized planes, the GPU culling pass tests the bounding spheres against them
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+};
+
+// The systems run on the job system. Schedule creates their jobs so they start once
+// after has finished (right away for nullptr) and returns the job that finishes with
+// the system. The world must not change structurally until that job has finished.
+
+// Marks the mesh renderers whose resources were removed as not visible.
+// Frustum culling happens on the GPU, see cull.comp.
+class CullingSystem
+{
+public:
+	static Job* Schedule(World& world, const ResourceRegistry& resources, Job* after);
+};
+
+// Flattens the visible mesh renderers into render items with their transform inputs,
+// and gathers the point lights
+class RenderExtractionSystem
+{
+public:
+	static Job* Schedule(World& world, const ResourceRegistry& resources, FrameData& frame, Job* after);
+	// Sorts the render items by shader, texture arrays, material and mesh
+	static Job* ScheduleSort(const ResourceRegistry& resources, FrameData& frame, Job* after);
+};
+
+// Batches the transforms of every render item into the frame's ObjectTransform array
+class TransformSystem
+{
+public:
+	static Job* Schedule(const glm::mat4& view, const glm::mat4& projection, FrameData& frame, Job* after);
+};
+
+// Gives each lit render item the point lights whose radius reaches it
+class LightAssignmentSystem
+{
+public:
+	static Job* Schedule(FrameData& frame, Job* after);
+
+	// Appends the lights reaching the bounding sphere to indices, returns how many
+	static unsigned int Assign(const glm::vec4& bounds, const std::vector<PointLightData>& pointLights, std::vector<unsigned int>& indices);
+};
+
+// Bounding sphere of a mesh renderer, xyz center and w radius
+glm::vec4 GetBounds(const Mesh* mesh, const TransformComponent& transform);
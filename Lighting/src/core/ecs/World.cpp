@@ -0,0 +1,187 @@
+#include "World.h"
+
+#include <cassert>
+
+static std::vector<ComponentInfo>& GetComponentInfos()
+{
+	static std::vector<ComponentInfo> infos;
+	return infos;
+}
+
+const ComponentInfo& ComponentRegistry::GetInfo(unsigned int id)
+{
+	return GetComponentInfos()[id];
+}
+
+unsigned int ComponentRegistry::Register(const ComponentInfo& info)
+{
+	auto& infos = GetComponentInfos();
+	assert(infos.size() < MAX_COMPONENT_TYPES && "Too many component types");
+
+	// Reserved up front so the ComponentInfo pointers held by columns never move
+	infos.reserve(MAX_COMPONENT_TYPES);
+	infos.push_back(info);
+	return static_cast<unsigned int>(infos.size() - 1);
+}
+
+ComponentColumn::ComponentColumn(unsigned int typeId) :
+	m_TypeId(typeId), m_Info(&ComponentRegistry::GetInfo(typeId)),
+	m_Data(nullptr), m_Size(0), m_Capacity(0)
+{
+}
+
+ComponentColumn::~ComponentColumn()
+{
+	for (size_t i = 0; i < m_Size; i++)
+		m_Info->destroy(Get(i));
+	::operator delete(m_Data);
+}
+
+ComponentColumn::ComponentColumn(ComponentColumn&& other) :
+	m_TypeId(other.m_TypeId), m_Info(other.m_Info),
+	m_Data(other.m_Data), m_Size(other.m_Size), m_Capacity(other.m_Capacity)
+{
+	other.m_Data = nullptr;
+	other.m_Size = 0;
+	other.m_Capacity = 0;
+}
+
+void* ComponentColumn::PushBack()
+{
+	if (m_Size == m_Capacity)
+		Grow();
+	return Get(m_Size++);
+}
+
+void ComponentColumn::SwapRemove(size_t row)
+{
+	size_t last = m_Size - 1;
+	m_Info->destroy(Get(row));
+	if (row != last)
+	{
+		m_Info->moveConstruct(Get(row), Get(last));
+		m_Info->destroy(Get(last));
+	}
+	m_Size--;
+}
+
+void ComponentColumn::Grow()
+{
+	size_t capacity = m_Capacity == 0 ? 16 : m_Capacity * 2;
+	unsigned char* data = static_cast<unsigned char*>(::operator new(capacity * m_Info->size));
+
+	for (size_t i = 0; i < m_Size; i++)
+	{
+		m_Info->moveConstruct(data + i * m_Info->size, Get(i));
+		m_Info->destroy(Get(i));
+	}
+
+	::operator delete(m_Data);
+	m_Data = data;
+	m_Capacity = capacity;
+}
+
+void World::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	EntityRecord& record = m_Records[entity.index];
+	RemoveRow(*m_Archetypes[record.archetype], record.row);
+
+	record.generation++;
+	record.archetype = NO_ARCHETYPE;
+	m_FreeIndices.push_back(entity.index);
+}
+
+bool World::IsAlive(Entity entity) const
+{
+	return entity.index < m_Records.size()
+		&& m_Records[entity.index].generation == entity.generation
+		&& m_Records[entity.index].archetype != NO_ARCHETYPE;
+}
+
+Archetype& World::GetOrCreateArchetype(ComponentMask mask)
+{
+	auto it = m_ArchetypeLookup.find(mask);
+	if (it != m_ArchetypeLookup.end())
+		return *m_Archetypes[it->second];
+
+	std::unique_ptr<Archetype> archetype = std::make_unique<Archetype>();
+	archetype->mask = mask;
+	for (int i = 0; i < MAX_COMPONENT_TYPES; i++)
+	{
+		archetype->columnOfType[i] = -1;
+		if (mask & (ComponentMask(1) << i))
+		{
+			archetype->columnOfType[i] = static_cast<int>(archetype->columns.size());
+			archetype->columns.emplace_back(static_cast<unsigned int>(i));
+		}
+	}
+
+	uint32_t index = static_cast<uint32_t>(m_Archetypes.size());
+	m_Archetypes.push_back(std::move(archetype));
+	m_ArchetypeLookup[mask] = index;
+	return *m_Archetypes[index];
+}
+
+Entity World::AllocateEntity(Archetype& archetype)
+{
+	uint32_t index;
+	if (!m_FreeIndices.empty())
+	{
+		index = m_FreeIndices.back();
+		m_FreeIndices.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(m_Records.size());
+		m_Records.push_back({ 0, NO_ARCHETYPE, 0 });
+	}
+
+	EntityRecord& record = m_Records[index];
+	record.archetype = m_ArchetypeLookup[archetype.mask];
+	record.row = static_cast<uint32_t>(archetype.entities.size());
+
+	Entity entity(index, record.generation);
+	archetype.entities.push_back(entity);
+	return entity;
+}
+
+Archetype& World::MoveEntity(Entity entity, ComponentMask newMask)
+{
+	Archetype& destination = GetOrCreateArchetype(newMask);
+	EntityRecord& record = m_Records[entity.index];
+	Archetype& source = *m_Archetypes[record.archetype];
+	uint32_t sourceRow = record.row;
+
+	// Move the components both archetypes share, the others are destroyed by RemoveRow
+	for (auto& column : source.columns)
+	{
+		int destinationColumn = destination.columnOfType[column.GetTypeId()];
+		if (destinationColumn < 0)
+			continue;
+
+		const ComponentInfo& info = ComponentRegistry::GetInfo(column.GetTypeId());
+		info.moveConstruct(destination.columns[destinationColumn].PushBack(), column.Get(sourceRow));
+	}
+
+	RemoveRow(source, sourceRow);
+
+	record.archetype = m_ArchetypeLookup[newMask];
+	record.row = static_cast<uint32_t>(destination.entities.size());
+	destination.entities.push_back(entity);
+	return destination;
+}
+
+void World::RemoveRow(Archetype& archetype, uint32_t row)
+{
+	for (auto& column : archetype.columns)
+		column.SwapRemove(row);
+
+	// The last entity took the removed row
+	Entity moved = archetype.entities.back();
+	archetype.entities[row] = moved;
+	archetype.entities.pop_back();
+	m_Records[moved.index].row = row;
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+#define MAX_COMPONENT_TYPES 64
+
+typedef uint64_t ComponentMask;
+
+// How to move and destroy a component type without knowing it
+struct ComponentInfo
+{
+	size_t size;
+	void (*moveConstruct)(void* destination, void* source);
+	void (*destroy)(void* component);
+};
+
+class ComponentRegistry
+{
+public:
+	template<typename T>
+	static unsigned int GetId()
+	{
+		static const unsigned int id = Register(MakeInfo<T>());
+		return id;
+	}
+
+	static const ComponentInfo& GetInfo(unsigned int id);
+
+private:
+	static unsigned int Register(const ComponentInfo& info);
+
+	template<typename T>
+	static ComponentInfo MakeInfo()
+	{
+		ComponentInfo info;
+		info.size = sizeof(T);
+		info.moveConstruct = [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); };
+		info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+		return info;
+	}
+};
+
+// Packed array of one component type inside an archetype
+class ComponentColumn
+{
+public:
+	explicit ComponentColumn(unsigned int typeId);
+	~ComponentColumn();
+
+	ComponentColumn(ComponentColumn&& other);
+	ComponentColumn(const ComponentColumn&) = delete;
+	ComponentColumn& operator=(const ComponentColumn&) = delete;
+	ComponentColumn& operator=(ComponentColumn&&) = delete;
+
+	inline void* Get(size_t row) { return m_Data + row * m_Info->size; }
+	inline unsigned int GetTypeId() const { return m_TypeId; }
+
+	// Returns uninitialized storage at the end of the column, the caller constructs into it
+	void* PushBack();
+	// Destroys the row and moves the last element into its place
+	void SwapRemove(size_t row);
+
+private:
+	unsigned int m_TypeId;
+	const ComponentInfo* m_Info;
+	unsigned char* m_Data;
+	size_t m_Size;
+	size_t m_Capacity;
+
+private:
+	void Grow();
+};
+
+// All entities that have exactly the same set of components
+struct Archetype
+{
+	ComponentMask mask;
+	std::vector<ComponentColumn> columns;
+	int columnOfType[MAX_COMPONENT_TYPES];		// -1 when the archetype does not have the type
+	std::vector<Entity> entities;
+
+	template<typename T>
+	inline T* GetColumn()
+	{
+		int column = columnOfType[ComponentRegistry::GetId<T>()];
+		return column < 0 || entities.empty() ? nullptr : static_cast<T*>(columns[column].Get(0));
+	}
+};
+
+// Archetype based entity storage: components of the same type are stored contiguously
+// per archetype and queries walk those arrays directly.
+// Creating, destroying or changing the components of an entity invalidates the pointers
+// handed out by Get and ForEach.
+class World
+{
+public:
+	World() = default;
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	template<typename... Ts>
+	Entity Create(Ts&&... components)
+	{
+		Archetype& archetype = GetOrCreateArchetype(MaskOf<typename std::decay<Ts>::type...>());
+		Entity entity = AllocateEntity(archetype);
+
+		int expand[] = { 0, (EmplaceComponent(archetype, std::forward<Ts>(components)), 0)... };
+		(void)expand;
+
+		return entity;
+	}
+
+	void Destroy(Entity entity);
+	bool IsAlive(Entity entity) const;
+
+	template<typename T>
+	T* Get(Entity entity)
+	{
+		if (!IsAlive(entity))
+			return nullptr;
+
+		const EntityRecord& record = m_Records[entity.index];
+		Archetype& archetype = *m_Archetypes[record.archetype];
+		int column = archetype.columnOfType[ComponentRegistry::GetId<T>()];
+		return column < 0 ? nullptr : static_cast<T*>(archetype.columns[column].Get(record.row));
+	}
+
+	template<typename T>
+	bool Has(Entity entity)
+	{
+		return Get<T>(entity) != nullptr;
+	}
+
+	template<typename T>
+	T* Add(Entity entity, T&& component)
+	{
+		typedef typename std::decay<T>::type Component;
+		if (!IsAlive(entity) || Has<Component>(entity))
+			return nullptr;
+
+		ComponentMask mask = m_Archetypes[m_Records[entity.index].archetype]->mask | MaskOf<Component>();
+		Archetype& archetype = MoveEntity(entity, mask);
+		EmplaceComponent(archetype, std::forward<T>(component));
+		return Get<Component>(entity);
+	}
+
+	template<typename T>
+	void Remove(Entity entity)
+	{
+		if (!Has<T>(entity))
+			return;
+
+		ComponentMask mask = m_Archetypes[m_Records[entity.index].archetype]->mask & ~MaskOf<T>();
+		MoveEntity(entity, mask);
+	}
+
+	// Calls f(Entity, Ts&...) for every entity that has all of Ts and none of the excluded components
+	template<typename... Ts, typename F>
+	void ForEach(F&& f, ComponentMask exclude = 0)
+	{
+		ForEachChunk<Ts...>([&f](size_t count, const Entity* entities, Ts*... components)
+		{
+			for (size_t i = 0; i < count; i++)
+				f(entities[i], components[i]...);
+		}, exclude);
+	}
+
+	// Calls f(count, const Entity*, Ts*...) once per matching archetype with its packed arrays
+	template<typename... Ts, typename F>
+	void ForEachChunk(F&& f, ComponentMask exclude = 0)
+	{
+		const ComponentMask required = MaskOf<Ts...>();
+		for (auto& archetype : m_Archetypes)
+		{
+			if ((archetype->mask & required) != required || (archetype->mask & exclude) != 0 || archetype->entities.empty())
+				continue;
+
+			f(archetype->entities.size(), archetype->entities.data(), archetype->GetColumn<Ts>()...);
+		}
+	}
+
+	template<typename... Ts>
+	static ComponentMask MaskOf()
+	{
+		ComponentMask mask = 0;
+		int expand[] = { 0, (mask |= ComponentMask(1) << ComponentRegistry::GetId<Ts>(), 0)... };
+		(void)expand;
+		return mask;
+	}
+
+	inline size_t GetEntityCount() const { return m_Records.size() - m_FreeIndices.size(); }
+	inline size_t GetArchetypeCount() const { return m_Archetypes.size(); }
+
+private:
+	struct EntityRecord
+	{
+		uint32_t generation;
+		uint32_t archetype;
+		uint32_t row;
+	};
+
+	static const uint32_t NO_ARCHETYPE = ~0u;
+
+	std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+	std::unordered_map<ComponentMask, uint32_t> m_ArchetypeLookup;
+
+	std::vector<EntityRecord> m_Records;
+	std::vector<uint32_t> m_FreeIndices;
+
+private:
+	Archetype& GetOrCreateArchetype(ComponentMask mask);
+	Entity AllocateEntity(Archetype& archetype);
+	Archetype& MoveEntity(Entity entity, ComponentMask newMask);
+	void RemoveRow(Archetype& archetype, uint32_t row);
+
+	template<typename T>
+	void EmplaceComponent(Archetype& archetype, T&& component)
+	{
+		typedef typename std::decay<T>::type Component;
+		ComponentColumn& column = archetype.columns[archetype.columnOfType[ComponentRegistry::GetId<Component>()]];
+		new (column.PushBack()) Component(std::forward<T>(component));
+	}
+};
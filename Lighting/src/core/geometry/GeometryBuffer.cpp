@@ -0,0 +1,118 @@
+#include "GeometryBuffer.h"
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+
+GeometryBuffer::GeometryBuffer() :
+	m_VertexHeap(MESH_VERTEX_STRIDE * sizeof(float), GEOMETRY_INITIAL_VERTICES),
+	m_IndexHeap(sizeof(unsigned int), GEOMETRY_INITIAL_INDICES)
+{
+}
+
+// Out of line, the GL wrappers are incomplete in the header
+GeometryBuffer::~GeometryBuffer() = default;
+
+GeometryRange GeometryBuffer::Add(const Mesh& mesh)
+{
+	unsigned int id;
+	if (!m_FreeEntries.empty())
+	{
+		id = m_FreeEntries.back();
+		m_FreeEntries.pop_back();
+	}
+	else
+	{
+		id = static_cast<unsigned int>(m_Entries.size());
+		m_Entries.emplace_back();
+	}
+
+	uint32_t vertexCount = static_cast<uint32_t>(mesh.GetVertsCount());
+	uint32_t indexCount = static_cast<uint32_t>(mesh.GetIndicesCount());
+	TlsfAllocator::Allocation vertices = m_VertexHeap.Allocate(vertexCount, id);
+	TlsfAllocator::Allocation indices = m_IndexHeap.Allocate(indexCount, id);
+	if (vertexCount > 0)
+		m_VertexHeap.Write(vertices.offset, mesh.GetVertices(), vertexCount);
+	if (indexCount > 0)
+		m_IndexHeap.Write(indices.offset, mesh.GetIndices(), indexCount);
+
+	Entry& entry = m_Entries[id];
+	entry.vertexBlock = vertices.block;
+	entry.indexBlock = indices.block;
+	entry.range.firstIndex = indices.offset;
+	entry.range.indexCount = indexCount;
+	entry.range.baseVertex = static_cast<int>(vertices.offset);
+	entry.range.id = id;
+
+	return entry.range;
+}
+
+void GeometryBuffer::Remove(const GeometryRange& range)
+{
+	Entry& entry = m_Entries[range.id];
+	if (entry.vertexBlock != TlsfAllocator::INVALID_BLOCK)
+		m_VertexHeap.Free(entry.vertexBlock);
+	if (entry.indexBlock != TlsfAllocator::INVALID_BLOCK)
+		m_IndexHeap.Free(entry.indexBlock);
+
+	entry.vertexBlock = TlsfAllocator::INVALID_BLOCK;
+	entry.indexBlock = TlsfAllocator::INVALID_BLOCK;
+	m_FreeEntries.push_back(range.id);
+}
+
+void GeometryBuffer::Upload()
+{
+	bool isVertexHeapRecreated = m_VertexHeap.Upload();
+	bool isIndexHeapRecreated = m_IndexHeap.Upload();
+	if (m_VA && !isVertexHeapRecreated && !isIndexHeapRecreated)
+		return;
+
+	if (!m_VBL)
+	{
+		m_VBL.reset(new VertexBufferLayout());
+		m_VBL->Push<float>(3);
+		m_VBL->Push<float>(3);
+		m_VBL->Push<float>(2);
+	}
+
+	// The previous vertex array goes through the deletion queue, frames in flight still use it
+	m_VA.reset(new VertexArray());
+	m_VA->AddVertexBuffer(m_VertexHeap.GetId(), *m_VBL);
+	m_VA->AddIndexBuffer(m_IndexHeap.GetId());
+}
+
+bool GeometryBuffer::Defragment(size_t byteBudget)
+{
+	m_Moves.clear();
+	m_VertexHeap.Defragment(byteBudget, m_Moves);
+	size_t vertexMoves = m_Moves.size();
+	m_IndexHeap.Defragment(byteBudget, m_Moves);
+
+	for (size_t i = 0; i < m_Moves.size(); i++)
+	{
+		const GpuHeap::Move& move = m_Moves[i];
+		Entry& entry = m_Entries[move.owner];
+		if (i < vertexMoves)
+		{
+			entry.vertexBlock = move.block;
+			entry.range.baseVertex = static_cast<int>(move.offset);
+		}
+		else
+		{
+			entry.indexBlock = move.block;
+			entry.range.firstIndex = move.offset;
+		}
+	}
+	return !m_Moves.empty();
+}
+
+void GeometryBuffer::Bind() const
+{
+	if (m_VA)
+		m_VA->Bind();
+}
+
+void GeometryBuffer::Unbind() const
+{
+	if (m_VA)
+		m_VA->Unbind();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Mesh.h"
+#include "GpuHeap.h"
+
+// Initial sizes of the heaps, they double when full
+#define GEOMETRY_INITIAL_VERTICES (64 * 1024)
+#define GEOMETRY_INITIAL_INDICES (256 * 1024)
+
+class VertexArray;
+class VertexBufferLayout;
+
+// Vertices and indices of every mesh in one vertex heap and one index heap, so a
+// whole pass is drawn with a single vertex array bound. Meshes get a range of each
+// heap, the space of removed meshes is reused and compacted a little every frame.
+class GeometryBuffer
+{
+public:
+	GeometryBuffer();
+	~GeometryBuffer();
+
+	GeometryRange Add(const Mesh& mesh);
+	void Remove(const GeometryRange& range);
+
+	// Writes the meshes added since the last call, on the thread owning the GL context
+	void Upload();
+	// Moves up to byteBudget bytes of geometry into the holes left by removed meshes.
+	// Returns true if a range changed, see GetRange.
+	bool Defragment(size_t byteBudget);
+	void Bind() const;
+	void Unbind() const;
+
+	// Where the mesh added as range.id is now
+	inline const GeometryRange& GetRange(unsigned int id) const { return m_Entries[id].range; }
+
+	inline const GpuHeap& GetVertexHeap() const { return m_VertexHeap; }
+	inline const GpuHeap& GetIndexHeap() const { return m_IndexHeap; }
+
+private:
+	struct Entry
+	{
+		GeometryRange range;
+		uint32_t vertexBlock;
+		uint32_t indexBlock;
+	};
+
+	GpuHeap m_VertexHeap;
+	GpuHeap m_IndexHeap;
+	std::vector<Entry> m_Entries;
+	std::vector<unsigned int> m_FreeEntries;
+	std::vector<GpuHeap::Move> m_Moves;
+
+	std::unique_ptr<VertexArray> m_VA;
+	std::unique_ptr<VertexBufferLayout> m_VBL;
+};
@@ -0,0 +1,137 @@
+#include "GpuHeap.h"
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <utility>
+
+#include "../resource/GpuDeletionQueue.h"
+
+// Fragmentation (see TlsfAllocator::GetFragmentation) above which allocations are moved
+#define DEFRAGMENT_THRESHOLD 0.25f
+// Allocations looked at per call, whether they could be moved or not
+#define DEFRAGMENT_MAX_ATTEMPTS 256
+
+GpuHeap::GpuHeap(uint32_t elementSize, uint32_t initialCapacity) :
+	m_Id(0), m_ElementSize(elementSize), m_BufferCapacity(0),
+	m_Allocator(initialCapacity)
+{
+}
+
+GpuHeap::~GpuHeap()
+{
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+}
+
+TlsfAllocator::Allocation GpuHeap::Allocate(uint32_t count, uint32_t owner)
+{
+	TlsfAllocator::Allocation allocation = m_Allocator.Allocate(count, owner);
+	if (allocation.block != TlsfAllocator::INVALID_BLOCK || count == 0)
+		return allocation;
+
+	// Double until it fits, the free tail may already cover part of the request
+	uint32_t capacity = m_Allocator.GetCapacity();
+	uint32_t newCapacity = capacity > 0 ? capacity * 2 : count;
+	while (newCapacity < capacity + count)
+		newCapacity *= 2;
+
+	m_Allocator.Grow(newCapacity);
+	return m_Allocator.Allocate(count, owner);
+}
+
+void GpuHeap::Free(uint32_t block)
+{
+	m_Allocator.Free(block);
+}
+
+void GpuHeap::Write(uint32_t offset, const void* data, uint32_t count)
+{
+	PendingWrite write;
+	write.offset = offset;
+	write.data.resize(static_cast<size_t>(count) * m_ElementSize);
+	std::memcpy(write.data.data(), data, write.data.size());
+	m_PendingWrites.push_back(std::move(write));
+}
+
+bool GpuHeap::Upload()
+{
+	bool isRecreated = false;
+	if (m_BufferCapacity < m_Allocator.GetCapacity())
+	{
+		// Immutable storage cannot grow, the content moves to a new buffer
+		unsigned int id;
+		glGenBuffers(1, &id);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_Allocator.GetCapacity()) * m_ElementSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+		if (m_Id != 0)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, m_Id);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(m_BufferCapacity) * m_ElementSize);
+			GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+		}
+
+		m_Id = id;
+		m_BufferCapacity = m_Allocator.GetCapacity();
+		isRecreated = true;
+	}
+
+	if (!m_PendingWrites.empty())
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_Id);
+		for (const PendingWrite& write : m_PendingWrites)
+			glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(write.offset) * m_ElementSize, write.data.size(), write.data.data());
+		m_PendingWrites.clear();
+	}
+
+	return isRecreated;
+}
+
+void GpuHeap::Defragment(size_t byteBudget, std::vector<Move>& moves)
+{
+	if (m_Id == 0 || m_Allocator.GetFragmentation() <= DEFRAGMENT_THRESHOLD)
+		return;
+
+	glBindBuffer(GL_COPY_READ_BUFFER, m_Id);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Id);
+
+	// Walk down from the top, allocations that fit in no lower hole stay where they are
+	size_t movedBytes = 0;
+	uint32_t block = m_Allocator.GetLastUsedBlock();
+	for (int attempt = 0; attempt < DEFRAGMENT_MAX_ATTEMPTS && block != TlsfAllocator::INVALID_BLOCK; attempt++)
+	{
+		if (movedBytes >= byteBudget || m_Allocator.GetFreeBlockCount() <= 1)
+			break;
+
+		uint32_t previous = m_Allocator.GetPreviousUsedBlock(block);
+		uint32_t offset = m_Allocator.GetOffset(block);
+		uint32_t size = m_Allocator.GetSize(block);
+		uint32_t owner = m_Allocator.GetOwner(block);
+
+		TlsfAllocator::Allocation target = m_Allocator.Allocate(size, owner);
+		if (target.block != TlsfAllocator::INVALID_BLOCK && target.offset > offset)
+		{
+			m_Allocator.Free(target.block);
+			target.block = TlsfAllocator::INVALID_BLOCK;
+		}
+
+		if (target.block != TlsfAllocator::INVALID_BLOCK)
+		{
+			// Both ranges are allocated, they cannot overlap
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				static_cast<GLintptr>(offset) * m_ElementSize, static_cast<GLintptr>(target.offset) * m_ElementSize,
+				static_cast<GLsizeiptr>(size) * m_ElementSize);
+			m_Allocator.Free(block);
+
+			Move move;
+			move.owner = owner;
+			move.block = target.block;
+			move.offset = target.offset;
+			moves.push_back(move);
+
+			movedBytes += static_cast<size_t>(size) * m_ElementSize;
+		}
+
+		block = previous;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "TlsfAllocator.h"
+
+// One large immutable GL buffer (glBufferStorage) sub-allocated in fixed size
+// elements. Allocation is CPU only: writes are queued and the buffer is created,
+// grown and written on the next Upload, on the thread owning the GL context.
+class GpuHeap
+{
+public:
+	// Where an allocation went, for the owner to patch what points into the heap
+	struct Move
+	{
+		uint32_t owner;
+		uint32_t block;
+		uint32_t offset;
+	};
+
+	GpuHeap(uint32_t elementSize, uint32_t initialCapacity);
+	~GpuHeap();
+
+	GpuHeap(const GpuHeap&) = delete;
+	GpuHeap& operator=(const GpuHeap&) = delete;
+
+	// Grows the heap when there is no room, the allocation never fails
+	TlsfAllocator::Allocation Allocate(uint32_t count, uint32_t owner);
+	void Free(uint32_t block);
+	// Copies count elements, written to the GL buffer on the next Upload
+	void Write(uint32_t offset, const void* data, uint32_t count);
+
+	// Returns true if the GL buffer was recreated, whatever referenced it must be rebound
+	bool Upload();
+
+	// Once the free space is scattered enough, moves the highest allocations down into
+	// the holes until the budget is spent. Must follow Upload.
+	void Defragment(size_t byteBudget, std::vector<Move>& moves);
+
+	inline unsigned int GetId() const { return m_Id; }
+	inline uint32_t GetElementSize() const { return m_ElementSize; }
+	inline const TlsfAllocator& GetAllocator() const { return m_Allocator; }
+
+private:
+	struct PendingWrite
+	{
+		uint32_t offset;
+		std::vector<unsigned char> data;
+	};
+
+	unsigned int m_Id;
+	uint32_t m_ElementSize;
+	uint32_t m_BufferCapacity;	// elements in the GL buffer, behind the allocator until Upload
+
+	TlsfAllocator m_Allocator;
+	std::vector<PendingWrite> m_PendingWrites;
+};
@@ -1,6 +1,7 @@
 #include "IndexBuffer.h"
 
 #include <glad/glad.h>
+#include "../resource/GpuDeletionQueue.h"
 
 #include <iostream>
 
@@ -15,7 +16,7 @@ IndexBuffer::IndexBuffer(const unsigned int* data, size_t size, size_t count)
 
 IndexBuffer::~IndexBuffer()
 {
-	glDeleteBuffers(1, &m_Id);
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
 }
 
 void IndexBuffer::Bind() const
@@ -1,83 +1,45 @@
 #include "Mesh.h"
 
-#include "VertexArray.h"
-#include "VertexBuffer.h"
-#include "VertexBufferLayout.h"
-#include "IndexBuffer.h"
-
-#include <iostream>
+#include <cmath>
 
 Mesh::Mesh(std::string&& name, const float* vertices, size_t vSize, VertexLayout layout, const unsigned int* indices, size_t iSize)
-	: m_VA(nullptr), m_VB(nullptr), m_VBL(nullptr), m_IB(nullptr), m_Name(name), m_VertsCount(0)
+	: m_Name(name), m_VertsCount(0), m_BoundingRadius(0.0f)
 {
-	m_VA = new VertexArray();
-
-	m_VB = new VertexBuffer(vertices, vSize);
-	m_VBL = new VertexBufferLayout();
+	size_t stride = 3;
 	switch (layout)
 	{
-		case VF:
-		{
-			m_VBL->Push<float>(3);
-			m_VertsCount = vSize / 3 * sizeof(float);
-			break;
-		}
-		case VFNF:
-		{
-			m_VBL->Push<float>(3);
-			m_VBL->Push<float>(3);
-			m_VertsCount = vSize / 6 * sizeof(float);
-			break;
-		}
-		case VFNFTF:
-		{
-			m_VBL->Push<float>(3);
-			m_VBL->Push<float>(3);
-			m_VBL->Push<float>(2);
-			m_VertsCount = vSize / 8 * sizeof(float);
-			break;
-		}
+		case VF: stride = 3; break;
+		case VFNF: stride = 6; break;
+		case VFNFTF: stride = 8; break;
 	}
+	m_VertsCount = vSize / (stride * sizeof(float));
 
-	m_VA->AddVertexBuffer(*m_VB, *m_VBL);
+	// Missing attributes are zeroed
+	m_Vertices.assign(m_VertsCount * MESH_VERTEX_STRIDE, 0.0f);
+	for (size_t v = 0; v < m_VertsCount; v++)
+	{
+		for (size_t i = 0; i < stride; i++)
+			m_Vertices[v * MESH_VERTEX_STRIDE + i] = vertices[v * stride + i];
+	}
 
 	if (indices)
 	{
-		m_IB = new IndexBuffer(indices, iSize, iSize / sizeof(unsigned int));
-		m_VA->AddIndexBuffer(*m_IB);
+		m_Indices.assign(indices, indices + iSize / sizeof(unsigned int));
 	}
-}
-
-Mesh::~Mesh()
-{
-	delete m_VA;
-	delete m_VBL;
-	delete m_IB;
-	delete m_VB;
-}
-
-void Mesh::Bind() const
-{
-	m_VA->Bind();
-}
-
-void Mesh::Unbind() const
-{
-	m_VA->Unbind();
-}
-
-size_t Mesh::GetIndicesCount() const
-{
-	if (m_IB)
-		return m_IB->GetCount();
 	else
-		return 0;
-}
+	{
+		m_Indices.resize(m_VertsCount);
+		for (size_t i = 0; i < m_VertsCount; i++)
+			m_Indices[i] = static_cast<unsigned int>(i);
+	}
 
-const unsigned int* Mesh::GetIndices() const 
-{ 
-	if (m_IB)
-		return m_IB->GetIndices();
-	else
-		return nullptr;
-}
\ No newline at end of file
+	// Bounding sphere for culling
+	float maxLengthSq = 0.0f;
+	for (size_t i = 0; i < m_Vertices.size(); i += MESH_VERTEX_STRIDE)
+	{
+		float lengthSq = m_Vertices[i] * m_Vertices[i] + m_Vertices[i + 1] * m_Vertices[i + 1] + m_Vertices[i + 2] * m_Vertices[i + 2];
+		if (lengthSq > maxLengthSq)
+			maxLengthSq = lengthSq;
+	}
+	m_BoundingRadius = std::sqrt(maxLengthSq);
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+// Floats per vertex once loaded: position, normal and texture coordinates
+#define MESH_VERTEX_STRIDE 8
 
 enum VertexLayout {
 	VF = 0,
@@ -8,29 +12,46 @@ enum VertexLayout {
 	VFNFTF
 };
 
+// Where a mesh lives in the shared GeometryBuffer
+struct GeometryRange
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	int baseVertex;
+	unsigned int id;		// GeometryBuffer entry, stays the same when the geometry moves
+
+	GeometryRange() : firstIndex(0), indexCount(0), baseVertex(0), id(0) {}
+};
+
+// CPU side geometry. Whatever the source layout, vertices are expanded to
+// MESH_VERTEX_STRIDE floats and non-indexed meshes get an index list, so every
+// mesh can be drawn from the same buffers with glDrawElements.
 class Mesh
 {
 public:
 	Mesh(std::string&& name, const float* vertices, size_t vSize, VertexLayout layout, const unsigned int* indices = nullptr, size_t iSize = 0);
-	~Mesh();
-
-	void Bind() const;
-	void Unbind() const;
 
 	inline size_t GetVertsCount() const { return m_VertsCount; }
-	size_t GetIndicesCount() const;
-	const unsigned int* GetIndices() const;
+	inline size_t GetIndicesCount() const { return m_Indices.size(); }
+	inline const float* GetVertices() const { return m_Vertices.data(); }
+	inline const unsigned int* GetIndices() const { return m_Indices.data(); }
+	// Radius of the bounding sphere centered on the mesh origin
+	inline float GetBoundingRadius() const { return m_BoundingRadius; }
+
+	// Set by the scene when the mesh is added to its GeometryBuffer and when it is moved
+	void SetGeometryRange(const GeometryRange& range) { m_GeometryRange = range; }
+	inline const GeometryRange& GetGeometryRange() const { return m_GeometryRange; }
 
 	void SetName(const std::string& name) { m_Name = name; }
 	inline const std::string& GetName() const { return m_Name; }
 
 private:
-	class VertexArray* m_VA;
-	class VertexBuffer* m_VB;
-	class VertexBufferLayout* m_VBL;
-	class IndexBuffer* m_IB;
+	std::vector<float> m_Vertices;
+	std::vector<unsigned int> m_Indices;
+	GeometryRange m_GeometryRange;
 
 	std::string m_Name;
 
 	size_t m_VertsCount;
-};
\ No newline at end of file
+	float m_BoundingRadius;
+};
@@ -0,0 +1,306 @@
+#include "TlsfAllocator.h"
+
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static uint32_t HighestBit(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return index;
+#else
+	return 31 - __builtin_clz(value);
+#endif
+}
+
+static uint32_t LowestBit(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+// Size class of a block: fl is the top bit, sl the next SL_LOG2 bits.
+// Sizes below SL_COUNT all go in the first level, one list per size.
+static void Mapping(uint32_t size, uint32_t slLog2, uint32_t& fl, uint32_t& sl)
+{
+	uint32_t slCount = 1 << slLog2;
+	if (size < slCount)
+	{
+		fl = 0;
+		sl = size;
+		return;
+	}
+
+	uint32_t top = HighestBit(size);
+	fl = top - slLog2 + 1;
+	sl = (size >> (top - slLog2)) - slCount;
+}
+
+TlsfAllocator::TlsfAllocator(uint32_t size) :
+	m_FlBitmap(0), m_LastBlock(INVALID_BLOCK), m_Capacity(0), m_Used(0), m_FreeBlockCount(0)
+{
+	for (uint32_t fl = 0; fl < FL_COUNT; fl++)
+	{
+		m_SlBitmaps[fl] = 0;
+		for (uint32_t sl = 0; sl < SL_COUNT; sl++)
+			m_FreeHeads[fl][sl] = INVALID_BLOCK;
+	}
+
+	if (size > 0)
+		Grow(size);
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(uint32_t size, uint32_t owner)
+{
+	Allocation allocation;
+	if (size == 0)
+		return allocation;
+
+	uint32_t block = FindFree(size);
+	if (block == INVALID_BLOCK)
+		return allocation;
+
+	RemoveFree(block);
+
+	// The remainder goes back to the free lists
+	uint32_t remainder = m_Blocks[block].size - size;
+	if (remainder > 0)
+	{
+		uint32_t split = CreateBlock(m_Blocks[block].offset + size, remainder);
+		m_Blocks[split].prevPhysical = block;
+		m_Blocks[split].nextPhysical = m_Blocks[block].nextPhysical;
+		if (m_Blocks[block].nextPhysical != INVALID_BLOCK)
+			m_Blocks[m_Blocks[block].nextPhysical].prevPhysical = split;
+		else
+			m_LastBlock = split;
+
+		m_Blocks[block].nextPhysical = split;
+		m_Blocks[block].size = size;
+		InsertFree(split);
+	}
+
+	m_Blocks[block].owner = owner;
+	m_Used += size;
+
+	allocation.offset = m_Blocks[block].offset;
+	allocation.block = block;
+	return allocation;
+}
+
+void TlsfAllocator::Free(uint32_t block)
+{
+	assert(block < m_Blocks.size() && !m_Blocks[block].isFree && "Freeing a block that is not allocated");
+	m_Used -= m_Blocks[block].size;
+
+	// Merge with the free neighbours so free space never sits in two adjacent blocks
+	uint32_t prev = m_Blocks[block].prevPhysical;
+	if (prev != INVALID_BLOCK && m_Blocks[prev].isFree)
+	{
+		RemoveFree(prev);
+		m_Blocks[prev].size += m_Blocks[block].size;
+		m_Blocks[prev].nextPhysical = m_Blocks[block].nextPhysical;
+		if (m_Blocks[block].nextPhysical != INVALID_BLOCK)
+			m_Blocks[m_Blocks[block].nextPhysical].prevPhysical = prev;
+		else
+			m_LastBlock = prev;
+
+		ReleaseBlock(block);
+		block = prev;
+	}
+
+	uint32_t next = m_Blocks[block].nextPhysical;
+	if (next != INVALID_BLOCK && m_Blocks[next].isFree)
+	{
+		RemoveFree(next);
+		m_Blocks[block].size += m_Blocks[next].size;
+		m_Blocks[block].nextPhysical = m_Blocks[next].nextPhysical;
+		if (m_Blocks[next].nextPhysical != INVALID_BLOCK)
+			m_Blocks[m_Blocks[next].nextPhysical].prevPhysical = block;
+		else
+			m_LastBlock = block;
+
+		ReleaseBlock(next);
+	}
+
+	InsertFree(block);
+}
+
+void TlsfAllocator::Grow(uint32_t newSize)
+{
+	if (newSize <= m_Capacity)
+		return;
+
+	uint32_t extra = newSize - m_Capacity;
+	if (m_LastBlock != INVALID_BLOCK && m_Blocks[m_LastBlock].isFree)
+	{
+		// Extend the free tail, its size class changes
+		RemoveFree(m_LastBlock);
+		m_Blocks[m_LastBlock].size += extra;
+		InsertFree(m_LastBlock);
+	}
+	else
+	{
+		uint32_t block = CreateBlock(m_Capacity, extra);
+		m_Blocks[block].prevPhysical = m_LastBlock;
+		if (m_LastBlock != INVALID_BLOCK)
+			m_Blocks[m_LastBlock].nextPhysical = block;
+		m_LastBlock = block;
+		InsertFree(block);
+	}
+
+	m_Capacity = newSize;
+}
+
+uint32_t TlsfAllocator::GetLastUsedBlock() const
+{
+	if (m_LastBlock == INVALID_BLOCK)
+		return INVALID_BLOCK;
+
+	// Free blocks are always merged, a free block is followed and preceded by used ones
+	if (m_Blocks[m_LastBlock].isFree)
+		return m_Blocks[m_LastBlock].prevPhysical;
+	return m_LastBlock;
+}
+
+uint32_t TlsfAllocator::GetPreviousUsedBlock(uint32_t block) const
+{
+	uint32_t prev = m_Blocks[block].prevPhysical;
+	if (prev != INVALID_BLOCK && m_Blocks[prev].isFree)
+		return m_Blocks[prev].prevPhysical;
+	return prev;
+}
+
+uint32_t TlsfAllocator::GetLargestFree() const
+{
+	if (m_FlBitmap == 0)
+		return 0;
+
+	// Every block of the highest non-empty list is in the same size class, look at all of them
+	uint32_t fl = HighestBit(m_FlBitmap);
+	uint32_t sl = HighestBit(m_SlBitmaps[fl]);
+	uint32_t largest = 0;
+	for (uint32_t block = m_FreeHeads[fl][sl]; block != INVALID_BLOCK; block = m_Blocks[block].nextFree)
+	{
+		if (m_Blocks[block].size > largest)
+			largest = m_Blocks[block].size;
+	}
+	return largest;
+}
+
+float TlsfAllocator::GetFragmentation() const
+{
+	uint32_t free = GetFree();
+	if (free == 0)
+		return 0.0f;
+	return 1.0f - static_cast<float>(GetLargestFree()) / static_cast<float>(free);
+}
+
+uint32_t TlsfAllocator::CreateBlock(uint32_t offset, uint32_t size)
+{
+	uint32_t index;
+	if (!m_UnusedBlocks.empty())
+	{
+		index = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+	}
+	else
+	{
+		index = static_cast<uint32_t>(m_Blocks.size());
+		m_Blocks.emplace_back();
+	}
+
+	Block& block = m_Blocks[index];
+	block.offset = offset;
+	block.size = size;
+	block.owner = 0;
+	block.prevPhysical = INVALID_BLOCK;
+	block.nextPhysical = INVALID_BLOCK;
+	block.prevFree = INVALID_BLOCK;
+	block.nextFree = INVALID_BLOCK;
+	block.isFree = false;
+	return index;
+}
+
+void TlsfAllocator::ReleaseBlock(uint32_t block)
+{
+	m_Blocks[block].isFree = false;
+	m_UnusedBlocks.push_back(block);
+}
+
+void TlsfAllocator::InsertFree(uint32_t block)
+{
+	uint32_t fl, sl;
+	Mapping(m_Blocks[block].size, SL_LOG2, fl, sl);
+
+	uint32_t head = m_FreeHeads[fl][sl];
+	m_Blocks[block].isFree = true;
+	m_Blocks[block].prevFree = INVALID_BLOCK;
+	m_Blocks[block].nextFree = head;
+	if (head != INVALID_BLOCK)
+		m_Blocks[head].prevFree = block;
+
+	m_FreeHeads[fl][sl] = block;
+	m_FlBitmap |= 1u << fl;
+	m_SlBitmaps[fl] |= 1u << sl;
+	m_FreeBlockCount++;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block)
+{
+	uint32_t fl, sl;
+	Mapping(m_Blocks[block].size, SL_LOG2, fl, sl);
+
+	uint32_t prev = m_Blocks[block].prevFree;
+	uint32_t next = m_Blocks[block].nextFree;
+	if (prev != INVALID_BLOCK)
+		m_Blocks[prev].nextFree = next;
+	else
+		m_FreeHeads[fl][sl] = next;
+	if (next != INVALID_BLOCK)
+		m_Blocks[next].prevFree = prev;
+
+	if (m_FreeHeads[fl][sl] == INVALID_BLOCK)
+	{
+		m_SlBitmaps[fl] &= ~(1u << sl);
+		if (m_SlBitmaps[fl] == 0)
+			m_FlBitmap &= ~(1u << fl);
+	}
+
+	m_Blocks[block].isFree = false;
+	m_FreeBlockCount--;
+}
+
+uint32_t TlsfAllocator::FindFree(uint32_t size) const
+{
+	// Round the request up to the next size class, any block of that class or above fits
+	uint64_t rounded = size;
+	if (size >= SL_COUNT)
+		rounded += (1ull << (HighestBit(size) - SL_LOG2)) - 1;
+	if (rounded > 0xFFFFFFFFull)
+		return INVALID_BLOCK;
+
+	uint32_t fl, sl;
+	Mapping(static_cast<uint32_t>(rounded), SL_LOG2, fl, sl);
+
+	uint32_t slMap = m_SlBitmaps[fl] & (~0u << sl);
+	if (slMap == 0)
+	{
+		uint32_t flMap = fl + 1 < FL_COUNT ? m_FlBitmap & (~0u << (fl + 1)) : 0;
+		if (flMap == 0)
+			return INVALID_BLOCK;
+
+		fl = LowestBit(flMap);
+		slMap = m_SlBitmaps[fl];
+	}
+
+	return m_FreeHeads[fl][LowestBit(slMap)];
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit allocator of offsets in a range, it never touches the
+// memory itself. Sizes and offsets are in whatever unit the owner chooses (vertices,
+// indices), allocation and free are O(1): free blocks are kept in lists indexed by
+// the position of their size's top bit and the next SL_LOG2 bits.
+class TlsfAllocator
+{
+public:
+	static const uint32_t INVALID_BLOCK = 0xFFFFFFFF;
+
+	struct Allocation
+	{
+		uint32_t offset;
+		uint32_t block;		// INVALID_BLOCK when there was no room
+
+		Allocation() : offset(0), block(INVALID_BLOCK) {}
+	};
+
+	explicit TlsfAllocator(uint32_t size = 0);
+
+	// Owner is whatever the caller needs to find the allocation back, see GetOwner
+	Allocation Allocate(uint32_t size, uint32_t owner = 0);
+	void Free(uint32_t block);
+
+	// Adds free space at the end of the range, allocations keep their offsets
+	void Grow(uint32_t newSize);
+
+	inline uint32_t GetOffset(uint32_t block) const { return m_Blocks[block].offset; }
+	inline uint32_t GetSize(uint32_t block) const { return m_Blocks[block].size; }
+	inline uint32_t GetOwner(uint32_t block) const { return m_Blocks[block].owner; }
+
+	// The allocation with the highest offset, what defragmentation moves first
+	uint32_t GetLastUsedBlock() const;
+	// The allocation right below block in memory, INVALID_BLOCK at the start
+	uint32_t GetPreviousUsedBlock(uint32_t block) const;
+
+	inline uint32_t GetCapacity() const { return m_Capacity; }
+	inline uint32_t GetUsed() const { return m_Used; }
+	inline uint32_t GetFree() const { return m_Capacity - m_Used; }
+	inline uint32_t GetFreeBlockCount() const { return m_FreeBlockCount; }
+	uint32_t GetLargestFree() const;
+	// 0 when all the free space is contiguous, close to 1 when it is scattered in small blocks
+	float GetFragmentation() const;
+
+private:
+	static const uint32_t SL_LOG2 = 4;
+	static const uint32_t SL_COUNT = 1 << SL_LOG2;
+	static const uint32_t FL_COUNT = 32;
+
+	struct Block
+	{
+		uint32_t offset;
+		uint32_t size;
+		uint32_t owner;
+		// Neighbours in memory, and in the free list of the block's size class
+		uint32_t prevPhysical;
+		uint32_t nextPhysical;
+		uint32_t prevFree;
+		uint32_t nextFree;
+		bool isFree;
+	};
+
+	std::vector<Block> m_Blocks;
+	std::vector<uint32_t> m_UnusedBlocks;
+
+	uint32_t m_FreeHeads[FL_COUNT][SL_COUNT];
+	uint32_t m_FlBitmap;
+	uint32_t m_SlBitmaps[FL_COUNT];
+
+	uint32_t m_LastBlock;	// highest offset, free or not
+	uint32_t m_Capacity;
+	uint32_t m_Used;
+	uint32_t m_FreeBlockCount;
+
+private:
+	uint32_t CreateBlock(uint32_t offset, uint32_t size);
+	void ReleaseBlock(uint32_t block);
+
+	void InsertFree(uint32_t block);
+	void RemoveFree(uint32_t block);
+	uint32_t FindFree(uint32_t size) const;
+};
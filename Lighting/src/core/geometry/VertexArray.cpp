@@ -3,6 +3,7 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
+#include "../resource/GpuDeletionQueue.h"
 
 VertexArray::VertexArray()
 {
@@ -11,7 +12,7 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	glDeleteVertexArrays(1, &m_Id);
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::VERTEX_ARRAY, m_Id);
 }
 
 void VertexArray::Bind() const
@@ -28,16 +29,7 @@ void VertexArray::AddVertexBuffer(const VertexBuffer& vb, const VertexBufferLayo
 {
 	Bind();
 	vb.Bind();
-	const std::vector<VertexBufferAttribute> attribs = layout.GetAttributes();
-	unsigned int offset = 0;
-	for (unsigned int i = 0; i < attribs.size(); i++)
-	{
-		const auto& attrib = attribs[i];
-		glVertexAttribPointer(i, attrib.count, attrib.type, attrib.normalized,
-			layout.GetStride(), (const void*)offset);
-		glEnableVertexAttribArray(i);
-		offset += attrib.count * VertexBufferAttribute::GetSizeOfType(attrib.type);
-	}
+	SetAttributes(layout);
 	Unbind();
 	vb.Unbind();
 }
@@ -48,4 +40,35 @@ void VertexArray::AddIndexBuffer(const IndexBuffer& ib)
 	ib.Bind();
 	Unbind();
 	ib.Unbind();
+}
+
+void VertexArray::AddVertexBuffer(unsigned int bufferId, const VertexBufferLayout& layout)
+{
+	Bind();
+	glBindBuffer(GL_ARRAY_BUFFER, bufferId);
+	SetAttributes(layout);
+	Unbind();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexArray::AddIndexBuffer(unsigned int bufferId)
+{
+	Bind();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferId);
+	Unbind();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void VertexArray::SetAttributes(const VertexBufferLayout& layout)
+{
+	const std::vector<VertexBufferAttribute> attribs = layout.GetAttributes();
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < attribs.size(); i++)
+	{
+		const auto& attrib = attribs[i];
+		glVertexAttribPointer(i, attrib.count, attrib.type, attrib.normalized,
+			layout.GetStride(), (const void*)offset);
+		glEnableVertexAttribArray(i);
+		offset += attrib.count * VertexBufferAttribute::GetSizeOfType(attrib.type);
+	}
 }
\ No newline at end of file
@@ -10,6 +10,12 @@ public:
 	void Unbind() const;
 	void AddVertexBuffer(const class VertexBuffer& vb, const class VertexBufferLayout& layout);
 	void AddIndexBuffer(const class IndexBuffer& ib);
+	// Same for buffers not owned by a VertexBuffer/IndexBuffer, such as a GpuHeap
+	void AddVertexBuffer(unsigned int bufferId, const class VertexBufferLayout& layout);
+	void AddIndexBuffer(unsigned int bufferId);
+
 private:
+	void SetAttributes(const class VertexBufferLayout& layout);
+
 	unsigned int m_Id;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "VertexBuffer.h"
 
 #include <glad/glad.h>
+#include "../resource/GpuDeletionQueue.h"
 
 VertexBuffer::VertexBuffer(const void* data, size_t size)
 {
@@ -12,7 +13,7 @@ VertexBuffer::VertexBuffer(const void* data, size_t size)
 
 VertexBuffer::~VertexBuffer()
 {
-	glDeleteBuffers(1, &m_Id);
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
 }
 
 void VertexBuffer::Bind() const
@@ -58,11 +58,17 @@ void ImGuiWindow::Update(bool isCursorDisabled, Scene* scene)
 	if (ImGui::CollapsingHeader("Point Lights"))
 		CreatePointLightsUI(scene);
 
+	if (ImGui::CollapsingHeader("Materials"))
+		CreateMaterialsUI(scene);
+
 	if (ImGui::CollapsingHeader("Directional Light"))
 		CreateDirectionalLightUI(scene->GetDirectionalLight());
 
 	if (ImGui::CollapsingHeader("Camera"))
 		CreateCameraUI(scene->GetCamera());
+
+	if (ImGui::CollapsingHeader("Geometry Memory"))
+		CreateGeometryUI(scene->GetGeometry());
 	
 	ImGui::End();
 
@@ -75,6 +81,16 @@ void ImGuiWindow::Render() const
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+void ImGuiWindow::EndFrame() const
+{
+	ImGui::EndFrame();
+}
+
+bool ImGuiWindow::IsActive() const
+{
+	return ImGui::IsAnyItemActive();
+}
+
 void ImGuiWindow::CreateCameraUI(Camera& camera)
 {
 	ImGui::SeparatorText("Properties");
@@ -123,9 +139,83 @@ void ImGuiWindow::CreateDirectionalLightUI(DirectionalLight& dirLight)
 	}
 }
 
+void ImGuiWindow::CreateGeometryUI(const GeometryBuffer& geometry)
+{
+	CreateHeapUI("Vertices", geometry.GetVertexHeap());
+	CreateHeapUI("Indices", geometry.GetIndexHeap());
+}
+
+void ImGuiWindow::CreateHeapUI(const char* name, const GpuHeap& heap)
+{
+	const TlsfAllocator& allocator = heap.GetAllocator();
+	const float toMB = static_cast<float>(heap.GetElementSize()) / (1024.0f * 1024.0f);
+	const float utilization = allocator.GetCapacity() > 0 ? static_cast<float>(allocator.GetUsed()) / allocator.GetCapacity() : 0.0f;
+
+	ImGui::SeparatorText(name);
+	ImGui::Text("Used: %.2f / %.2f MB", allocator.GetUsed() * toMB, allocator.GetCapacity() * toMB);
+	ImGui::ProgressBar(utilization);
+	ImGui::Text("Free blocks: %u, largest %.2f MB", allocator.GetFreeBlockCount(), allocator.GetLargestFree() * toMB);
+	ImGui::Text("Fragmentation: %.1f%%", allocator.GetFragmentation() * 100.0f);
+}
+
+bool ImGuiWindow::CreateTransformUI(TransformComponent& transform)
+{
+	bool isChanged = false;
+
+	// Object position
+	float position[3] = { transform.position.x, transform.position.y, transform.position.z };
+	if (ImGui::DragFloat3("Position", position))
+	{
+		transform.position = glm::vec3(position[0], position[1], position[2]);
+		isChanged = true;
+	}
+
+	// Object rotation
+	float rotation[3] = { transform.rotation.x, transform.rotation.y, transform.rotation.z };
+	if (ImGui::DragFloat3("Rotation", rotation, 1.0f, -180.0f, 180.0f))
+	{
+		transform.SetRotation(glm::vec3(rotation[0], rotation[1], rotation[2]));
+		isChanged = true;
+	}
+
+	// Object scale
+	const glm::vec3 objectScale = transform.scale;
+	float scale[3] = { objectScale.x, objectScale.y, objectScale.z };
+	if (ImGui::DragFloat3("Scale", scale, 0.1f, 0.1f, 10.0f))
+	{
+		if (transform.isUniformScaling)
+		{
+			// Synchronizing XYZ sliders based on the one that is being modified
+			if (scale[0] != objectScale.x)
+			{
+				scale[1] = scale[0];
+				scale[2] = scale[0];
+			}
+			else if (scale[1] != objectScale.y)
+			{
+				scale[0] = scale[1];
+				scale[2] = scale[1];
+			}
+			else if (scale[2] != objectScale.z)
+			{
+				scale[0] = scale[2];
+				scale[1] = scale[2];
+			}
+		}
+
+		transform.scale = glm::vec3(scale[0], scale[1], scale[2]);
+		isChanged = true;
+	}
+
+	ImGui::SameLine();
+	ImGui::Checkbox("isUniform", &transform.isUniformScaling);
+
+	return isChanged;
+}
+
 void ImGuiWindow::CreateObjectsUI(Scene* scene)
 {
-	auto& objects = scene->GetObjects();
+	World& world = scene->GetWorld();
 	auto& meshes = scene->GetMeshes();
 	auto& materials = scene->GetMaterials();
 	auto& shaders = scene->GetShaders();
@@ -147,20 +237,9 @@ void ImGuiWindow::CreateObjectsUI(Scene* scene)
 		if (ImGui::Button("OK"))
 		{
 			// Creating the new object
-			std::unique_ptr<Object> newObject = std::make_unique<Object>(
-				std::string(m_Buffer),
-				meshes.at(m_SelectedMesh).get(),
-				materials.at(m_SelectedMaterial).get(),
-				shaders.at(m_SelectedShader).get()
-			);
-			scene->AddObject(std::move(newObject));
-
-			// Reset inputs
-			m_SelectedMesh = 0;
-			m_SelectedMaterial = 0;
-			m_SelectedShader = 0;
-			std::memset(m_Buffer, 0, sizeof(m_Buffer));
-			strcpy_s(m_Buffer, sizeof(m_Buffer), "Unnamed");
+			scene->CreateObject(std::string(m_Buffer), m_SelectedMesh, m_SelectedMaterial, m_SelectedShader);
+
+			ResetInputs();
 
 			ImGui::CloseCurrentPopup();
 		}
@@ -174,100 +253,57 @@ void ImGuiWindow::CreateObjectsUI(Scene* scene)
 		ImGui::EndPopup();
 	}
 
-	// Scene tree
-	for (int i = 0; i < objects.size(); i++)
+	// Scene tree, entities are destroyed after the loop so the component arrays stay valid
+	Entity toDestroy;
+	bool isFirst = true;
+	world.ForEach<NameComponent, TransformComponent, MeshRendererComponent>(
+		[&](Entity entity, NameComponent& name, TransformComponent& transform, MeshRendererComponent& renderer)
 	{
-		ImGui::PushID("Object " + i);
+		ImGui::PushID(static_cast<int>(entity.index));
 
-		if (i == 0)
+		if (isFirst)
 			ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+		isFirst = false;
 
-		if (ImGui::TreeNode((void*)(intptr_t)i, objects[i]->GetName().c_str(), i))
+		if (ImGui::TreeNode(name.name.c_str()))
 		{
-			
 			ImGui::SeparatorText("Properties");
 
-			// Object position
-			auto objectPos = objects[i]->GetPosition();
-			float position[3] = { objectPos.x, objectPos.y, objectPos.z };
-			if (ImGui::DragFloat3("Position", position))
-				objects[i]->SetPosition(glm::vec3(position[0], position[1], position[2]));
-
-			// Object rotation
-			auto objectRot = objects[i]->GetRotation();
-			float rotation[3] = { objectRot.x, objectRot.y, objectRot.z };
-			if (ImGui::DragFloat3("Rotation", rotation, 1.0f, -180.0f, 180.0f))
-				objects[i]->SetRotation(glm::vec3(rotation[0], rotation[1], rotation[2]));
-
-			// Object scale
-			bool& isUniformScaling = objects[i]->isUniformScaling;
-			auto objectScale = objects[i]->GetScale();
-			float scale[3] = { objectScale.x, objectScale.y, objectScale.z };
-			if (ImGui::DragFloat3("Scale", scale, 0.1f, 0.1f, 10.0f))
-			{
-				if (isUniformScaling)
-				{
-					// Synchronizing XYZ sliders based on the one that is being modified
-					if (scale[0] != objectScale.x)
-					{
-						scale[1] = scale[0];
-						scale[2] = scale[0];
-					}
-					else if (scale[1] != objectScale.y)
-					{
-						scale[0] = scale[1];
-						scale[2] = scale[1];
-					}
-					else if (scale[2] != objectScale.z)
-					{
-						scale[0] = scale[2];
-						scale[1] = scale[2];
-					}
-
-					objects[i]->SetScale(glm::vec3(scale[0], scale[1], scale[2]));
-				}
-				else
-				{
-					objects[i]->SetScale(glm::vec3(scale[0], scale[1], scale[2]));
-				}
-
-			}
-
-			ImGui::SameLine();
-			ImGui::Checkbox("isUniform", &isUniformScaling);
+			// Moving an object patches its draw, swapping a resource rebuilds the draw list
+			if (CreateTransformUI(transform))
+				scene->MarkTransformChanged(entity);
 
 			ImGui::NewLine();
 
-			// Object mesh
-			if (CreateCombobox(meshes, &objects[i]->selectedMesh, "Mesh"))
-				objects[i]->SetMesh(meshes.at(objects[i]->selectedMesh).get());
-
-			// Object material
-			if (CreateCombobox(materials, &objects[i]->selectedMaterial, "Material"))
-				objects[i]->SetMaterial(materials.at(objects[i]->selectedMaterial).get());
-
-			// Object shader
-			if (CreateCombobox(shaders, &objects[i]->selectedShader, "Shader"))
-				objects[i]->SetShader(shaders.at(objects[i]->selectedShader).get());
+			// Object mesh, material and shader
+			bool isSwapped = CreateCombobox(meshes, &renderer.mesh, "Mesh");
+			isSwapped |= CreateCombobox(materials, &renderer.material, "Material");
+			isSwapped |= CreateCombobox(shaders, &renderer.shader, "Shader");
+			if (isSwapped)
+				scene->MarkStructureChanged();
 
 			ImGui::Separator();
 
 			// Delete button
 			ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.66f, 0.2f, 0.2f, 1.0f));
 			if (ImGui::Button("Remove"))
-			{
-				scene->RemoveObject(i);
-			}
+				toDestroy = entity;
 			ImGui::PopStyleColor();
 			ImGui::TreePop();
 		}
 		ImGui::PopID();
-	}
+	}, World::MaskOf<PointLightComponent>());
+
+	if (toDestroy.IsValid())
+		scene->DestroyEntity(toDestroy);
 }
 
 void ImGuiWindow::CreatePointLightsUI(Scene* scene)
 {
-	auto& lights = scene->GetPointLights();
+	World& world = scene->GetWorld();
+	auto& meshes = scene->GetMeshes();
+	auto& materials = scene->GetMaterials();
+	auto& shaders = scene->GetShaders();
 
 	// Add point light button
 	if (ImGui::Button("Add point light"))
@@ -278,25 +314,17 @@ void ImGuiWindow::CreatePointLightsUI(Scene* scene)
 	{
 		ImGui::InputText("Name", m_Buffer, sizeof(m_Buffer));
 
+		CreateCombobox(meshes, &m_SelectedMesh, "Mesh");
+		CreateCombobox(materials, &m_SelectedMaterial, "Material");
+		CreateCombobox(shaders, &m_SelectedShader, "Shader");
+
 		// Confirm button
 		if (ImGui::Button("OK"))
 		{
-			// Creating the new point light (with hardcoded indices :/)
-			std::unique_ptr<PointLight> newLight = std::make_unique<PointLight>(
-				std::string(m_Buffer),
-				scene->GetMeshes().at(1).get(),
-				scene->GetMaterials().at(0).get(),
-				scene->GetShaders().at(3).get()
-			);
-			newLight->SetScale(glm::vec3(0.2));
-			scene->AddPointLight(std::move(newLight));
-
-			// Reset inputs
-			m_SelectedMesh = 0;
-			m_SelectedMaterial = 0;
-			m_SelectedShader = 0;
-			std::memset(m_Buffer, 0, sizeof(m_Buffer));
-			strcpy_s(m_Buffer, sizeof(m_Buffer), "Unnamed");
+			// Creating the new point light
+			scene->CreatePointLight(std::string(m_Buffer), m_SelectedMesh, m_SelectedMaterial, m_SelectedShader, glm::vec3(0.0f), glm::vec3(1.0f));
+
+			ResetInputs();
 
 			ImGui::CloseCurrentPopup();
 		}
@@ -310,79 +338,142 @@ void ImGuiWindow::CreatePointLightsUI(Scene* scene)
 		ImGui::EndPopup();
 	}
 
-	for (int i = 0; i < lights.size(); i++)
+	Entity toDestroy;
+	world.ForEach<NameComponent, TransformComponent, PointLightComponent>(
+		[&](Entity entity, NameComponent& name, TransformComponent& transform, PointLightComponent& light)
 	{
-		ImGui::PushID("Point light " + i);
+		ImGui::PushID(static_cast<int>(entity.index));
 
-		if (ImGui::TreeNode((void*)(intptr_t)i, lights[i]->GetName().c_str(), i))
+		if (ImGui::TreeNode(name.name.c_str()))
 		{
 			ImGui::SeparatorText("Properties");
 
-			// Object position
-			auto objectPos = lights[i]->GetPosition();
-			float position[3] = { objectPos.x, objectPos.y, objectPos.z };
+			// Light edits change what every object around it receives
+			bool isChanged = false;
+
+			// Light position
+			float position[3] = { transform.position.x, transform.position.y, transform.position.z };
 			if (ImGui::DragFloat3("Position", position))
-				lights[i]->SetPosition(glm::vec3(position[0], position[1], position[2]));
+			{
+				transform.position = glm::vec3(position[0], position[1], position[2]);
+				isChanged = true;
+			}
 
-			float radius = lights[i]->GetRadius();
-			if (ImGui::DragFloat("Radius", &radius, 0.1f, 0.0f, 100.0f))
-				lights[i]->SetRadius(radius);
+			isChanged |= ImGui::DragFloat("Radius", &light.radius, 0.1f, 0.0f, 100.0f);
 
 			// Change light settings
-			float color[3] = { lights[i]->GetColor().r, lights[i]->GetColor().g, lights[i]->GetColor().b };
-			float intensity = lights[i]->GetIntensity();
+			float color[3] = { light.color.r, light.color.g, light.color.b };
+			float intensity = light.intensity;
 			const float ambStrength = 0.2f;
 			const float difStrength = 0.5f;
 
 			// Color
 			if (ImGui::ColorEdit3("Color", color))
 			{
-				lights[i]->SetColor(glm::vec3(color[0], color[1], color[2]));
-				lights[i]->SetAmbient(glm::vec3(intensity * ambStrength * color[0], intensity * ambStrength * color[1], intensity * ambStrength * color[2]));
-				lights[i]->SetDiffuse(glm::vec3(intensity * difStrength * color[0], intensity * difStrength * color[1], intensity * difStrength * color[2]));
-				lights[i]->SetSpecular(glm::vec3(color[0], color[1], color[2]));
+				light.color = glm::vec3(color[0], color[1], color[2]);
+				light.ambient = glm::vec3(intensity * ambStrength * color[0], intensity * ambStrength * color[1], intensity * ambStrength * color[2]);
+				light.diffuse = glm::vec3(intensity * difStrength * color[0], intensity * difStrength * color[1], intensity * difStrength * color[2]);
+				light.specular = glm::vec3(color[0], color[1], color[2]);
+				isChanged = true;
 			}
 
 			// Intensity
 			if (ImGui::DragFloat("Intensity", &intensity, 0.01f, 0.0f, 1.0f))
 			{
-				lights[i]->SetIntensity(intensity);
-				lights[i]->SetAmbient(glm::vec3(intensity * ambStrength * color[0], intensity * ambStrength * color[1], intensity * ambStrength * color[2]));
-				lights[i]->SetDiffuse(glm::vec3(intensity * difStrength * color[0], intensity * difStrength * color[1], intensity * difStrength * color[2]));
-				lights[i]->SetSpecular(glm::vec3(intensity * color[0], intensity * color[1], intensity * color[2]));
+				light.intensity = intensity;
+				light.ambient = glm::vec3(intensity * ambStrength * color[0], intensity * ambStrength * color[1], intensity * ambStrength * color[2]);
+				light.diffuse = glm::vec3(intensity * difStrength * color[0], intensity * difStrength * color[1], intensity * difStrength * color[2]);
+				light.specular = glm::vec3(intensity * color[0], intensity * color[1], intensity * color[2]);
+				isChanged = true;
 			}
 
+			if (isChanged)
+				scene->MarkStructureChanged();
+
 			ImGui::Separator();
 
 			// Delete button
 			ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.66f, 0.2f, 0.2f, 1.0f));
 			if (ImGui::Button("Remove"))
-			{
-				scene->RemovePointLight(i);
-			}
+				toDestroy = entity;
 			ImGui::PopStyleColor();
 			ImGui::TreePop();
 		}
 		ImGui::PopID();
+	});
+
+	if (toDestroy.IsValid())
+		scene->DestroyEntity(toDestroy);
+}
+
+void ImGuiWindow::CreateMaterialsUI(Scene* scene)
+{
+	auto& materials = scene->GetMaterials();
+	CreateCombobox(materials, &m_EditedMaterial, "Material");
+
+	// Setters flag the material, only edited ones are uploaded
+	Material* material = materials.Get(m_EditedMaterial);
+	if (material)
+	{
+		ImGui::SeparatorText("Properties");
+
+		float ambient[3] = { material->GetAmbient().r, material->GetAmbient().g, material->GetAmbient().b };
+		if (ImGui::ColorEdit3("Ambient", ambient))
+			material->SetAmbient(glm::vec3(ambient[0], ambient[1], ambient[2]));
+
+		float diffuse[3] = { material->GetDiffuse().r, material->GetDiffuse().g, material->GetDiffuse().b };
+		if (ImGui::ColorEdit3("Diffuse", diffuse))
+			material->SetDiffuse(glm::vec3(diffuse[0], diffuse[1], diffuse[2]));
+
+		float specular[3] = { material->GetSpecular().r, material->GetSpecular().g, material->GetSpecular().b };
+		if (ImGui::ColorEdit3("Specular", specular))
+			material->SetSpecular(glm::vec3(specular[0], specular[1], specular[2]));
+
+		float shininess = material->GetShininess();
+		if (ImGui::DragFloat("Shininess", &shininess, 1.0f, 1.0f, 256.0f))
+			material->SetShininess(shininess);
 	}
+
+	ImGui::Text("Materials uploaded last frame: %zu (%zu skipped)", scene->GetMaterialBuffer().GetUploadCount(), scene->GetMaterialBuffer().GetSkipCount());
+	ImGui::Text("Light and view uniforms uploaded last frame: %zu (%zu skipped)", scene->GetUniformUploadCount(), scene->GetUniformSkipCount());
+	ImGui::Text("Draw list rebuilds: %zu, draws patched: %zu, unchanged snapshots: %zu",
+		scene->GetDrawListRebuildCount(), scene->GetPatchedDrawCount(), scene->GetSkippedSnapshotCount());
+}
+
+void ImGuiWindow::ResetInputs()
+{
+	m_SelectedMesh = MeshHandle();
+	m_SelectedMaterial = MaterialHandle();
+	m_SelectedShader = ShaderHandle();
+	std::memset(m_Buffer, 0, sizeof(m_Buffer));
+	strcpy_s(m_Buffer, sizeof(m_Buffer), "Unnamed");
 }
 
 template <class T>
-bool ImGuiWindow::CreateCombobox(std::vector<std::unique_ptr<T>>& vector, int* selected, std::string&& text)
+bool ImGuiWindow::CreateCombobox(SlotMap<T>& resources, Handle<T>* selected, std::string&& text)
 {
 	bool ret = false;
 
 	ImGui::PushID(text.c_str());
 	std::vector<const char*> names;
-	for (const auto& el : vector)
+	for (const auto& el : resources)
 	{
 		names.push_back(el->GetName().c_str());
 	}
 
 	if (!names.empty())
-		ret = ImGui::Combo(text.c_str(), selected, names.data(), static_cast<int>(names.size()));
+	{
+		// Unset handles pick the first resource, stale ones show an empty selection
+		if (!selected->IsValid())
+			*selected = resources.GetHandleAt(0);
+		int index = resources.IndexOf(*selected);
+
+		ret = ImGui::Combo(text.c_str(), &index, names.data(), static_cast<int>(names.size()));
+		if (ret)
+			*selected = resources.GetHandleAt(index);
+	}
 	else
-		ImGui::Text("No %s available", text);
+		ImGui::Text("No %s available", text.c_str());
 
 	ImGui::PopID();
 
@@ -11,7 +11,7 @@ class ImGuiWindow
 {
 public:
 	ImGuiWindow() :
-		m_SelectedMesh(0), m_SelectedMaterial(0), m_SelectedShader(0), m_Buffer("Unnamed")
+		m_SelectedMesh(), m_SelectedMaterial(), m_SelectedShader(), m_EditedMaterial(), m_Buffer("Unnamed")
 	{
 	}
 
@@ -20,19 +20,29 @@ public:
 	void Shutdown();
 	void Update(bool isCursorDisabled, Scene* scene);
 	void Render() const;
+	// Ends a frame built by Update that is not drawn
+	void EndFrame() const;
+	// Whether a widget is being dragged or typed in, the UI keeps being drawn meanwhile
+	bool IsActive() const;
 
 private:
 	void CreateCameraUI(Camera& camera);
 	void CreateDirectionalLightUI(DirectionalLight& dirLight);
 	void CreateObjectsUI(Scene* scene);
 	void CreatePointLightsUI(Scene* scene);
+	void CreateMaterialsUI(Scene* scene);
+	bool CreateTransformUI(TransformComponent& transform);
+	void CreateGeometryUI(const GeometryBuffer& geometry);
+	void CreateHeapUI(const char* name, const GpuHeap& heap);
 
 	template <class T>
-	bool CreateCombobox(std::vector<std::unique_ptr<T>>& vector, int* selected, std::string&& text);
+	bool CreateCombobox(SlotMap<T>& resources, Handle<T>* selected, std::string&& text);
+	void ResetInputs();
 
 private:
-	int m_SelectedMesh;
-	int m_SelectedMaterial;
-	int m_SelectedShader;
+	MeshHandle m_SelectedMesh;
+	MaterialHandle m_SelectedMaterial;
+	ShaderHandle m_SelectedShader;
+	MaterialHandle m_EditedMaterial;
 	char m_Buffer[128];
 };
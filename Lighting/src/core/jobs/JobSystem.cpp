@@ -0,0 +1,262 @@
+#include "JobSystem.h"
+
+#include <cassert>
+
+// Index of the worker owned by the calling thread, the submitting thread is 0
+static thread_local unsigned int t_WorkerIndex = 0;
+
+// Failed attempts to find work before an idle worker goes to sleep
+#define IDLE_SPIN_COUNT 64
+
+static void LockContinuations(Job* job)
+{
+	while (job->lock.exchange(true, std::memory_order_acquire))
+		std::this_thread::yield();
+}
+
+static void UnlockContinuations(Job* job)
+{
+	job->lock.store(false, std::memory_order_release);
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem instance;
+	return instance;
+}
+
+JobSystem::JobSystem() :
+	m_IsRunning(false), m_SleepingCount(0), m_QueuedCount(0)
+{
+	// The submitting thread can run jobs before Init, it simply has nobody to share them with
+	m_Workers.push_back(CreateWorker(1));
+}
+
+std::unique_ptr<JobSystem::Worker> JobSystem::CreateWorker(uint32_t seed)
+{
+	std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+	worker->jobs.reset(new Job[MAX_JOBS_PER_WORKER]);
+	worker->nextJob = 0;
+	worker->random = seed;
+	for (size_t i = 0; i < MAX_JOBS_PER_WORKER; i++)
+	{
+		worker->jobs[i].unfinished.store(0);
+		worker->jobs[i].dependencies.store(0);
+		worker->jobs[i].lock.store(false);
+	}
+	return worker;
+}
+
+void JobSystem::Init(unsigned int workerThreads)
+{
+	assert(m_Threads.empty() && "The job system is already running");
+
+	if (workerThreads == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		workerThreads = cores > 1 ? cores - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < workerThreads; i++)
+		m_Workers.push_back(CreateWorker(i + 2));
+
+	m_IsRunning = true;
+	for (unsigned int i = 1; i <= workerThreads; i++)
+		m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+void JobSystem::Shutdown()
+{
+	m_IsRunning = false;
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_WakeCondition.notify_all();
+	}
+
+	for (auto& thread : m_Threads)
+		thread.join();
+	m_Threads.clear();
+	m_Workers.resize(1);
+}
+
+Job* JobSystem::Create(std::function<void()> function, Job* parent)
+{
+	Worker& worker = GetCurrentWorker();
+	Job* job = &worker.jobs[worker.nextJob++ & (MAX_JOBS_PER_WORKER - 1)];
+	assert(job->unfinished.load() == 0 && "Job ring overflow, a job is recycled before it finished");
+
+	job->function = std::move(function);
+	job->parent = parent;
+	job->unfinished.store(1);
+	job->dependencies.store(1);
+
+	// The previous user of this slot may still be leaving Finish
+	LockContinuations(job);
+	job->continuationCount = 0;
+	UnlockContinuations(job);
+
+	if (parent)
+		parent->unfinished.fetch_add(1);
+
+	return job;
+}
+
+void JobSystem::AddDependency(Job* job, Job* dependency)
+{
+	LockContinuations(dependency);
+	// Finish reads the list under the same lock, so either it sees this job or we see it finished
+	if (dependency->unfinished.load() > 0)
+	{
+		assert(dependency->continuationCount < MAX_JOB_CONTINUATIONS && "Too many continuations");
+		job->dependencies.fetch_add(1);
+		dependency->continuations[dependency->continuationCount++] = job;
+	}
+	UnlockContinuations(dependency);
+}
+
+Job* JobSystem::Then(Job* job, std::function<void()> function)
+{
+	Job* continuation = Create(std::move(function));
+	AddDependency(continuation, job);
+	Run(continuation);
+	return continuation;
+}
+
+void JobSystem::Run(Job* job)
+{
+	ReleaseDependency(job);
+}
+
+void JobSystem::Wait(const Job* job)
+{
+	while (!IsComplete(job))
+	{
+		Job* next = GetJob();
+		if (next)
+			Execute(next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	t_WorkerIndex = index;
+
+	int idleCount = 0;
+	while (m_IsRunning)
+	{
+		Job* job = GetJob();
+		if (job)
+		{
+			Execute(job);
+			idleCount = 0;
+			continue;
+		}
+
+		if (++idleCount < IDLE_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Counted as sleeping before the queue is checked, so a push either sees the
+		// sleeper and notifies under the lock or is seen by the predicate
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepingCount++;
+		m_WakeCondition.wait(lock, [this]() { return m_QueuedCount.load() > 0 || !m_IsRunning; });
+		m_SleepingCount--;
+		idleCount = 0;
+	}
+}
+
+JobSystem::Worker& JobSystem::GetCurrentWorker()
+{
+	return *m_Workers[t_WorkerIndex];
+}
+
+Job* JobSystem::GetJob()
+{
+	Worker& worker = GetCurrentWorker();
+	Job* job = worker.deque.Pop();
+	if (job)
+	{
+		m_QueuedCount.fetch_sub(1);
+		return job;
+	}
+
+	// Steal from a random victim, then walk the others once
+	size_t count = m_Workers.size();
+	if (count < 2)
+		return nullptr;
+
+	worker.random ^= worker.random << 13;
+	worker.random ^= worker.random >> 17;
+	worker.random ^= worker.random << 5;
+	size_t start = worker.random % count;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t victim = (start + i) % count;
+		if (victim == t_WorkerIndex)
+			continue;
+
+		job = m_Workers[victim]->deque.Steal();
+		if (job)
+		{
+			m_QueuedCount.fetch_sub(1);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::Push(Job* job)
+{
+	// A full deque means the graph is wider than the ring, run the job right away
+	if (!GetCurrentWorker().deque.Push(job))
+	{
+		Execute(job);
+		return;
+	}
+
+	// Sequentially consistent with the sleeper side, the lock is only taken when someone sleeps
+	m_QueuedCount.fetch_add(1);
+	if (m_SleepingCount.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_WakeCondition.notify_one();
+	}
+}
+
+void JobSystem::Execute(Job* job)
+{
+	if (job->function)
+		job->function();
+	Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+	Job* parent = job->parent;
+	if (job->unfinished.fetch_sub(1) != 1)
+		return;
+
+	LockContinuations(job);
+	int count = job->continuationCount;
+	Job* continuations[MAX_JOB_CONTINUATIONS];
+	std::copy(job->continuations, job->continuations + count, continuations);
+	UnlockContinuations(job);
+
+	for (int i = 0; i < count; i++)
+		ReleaseDependency(continuations[i]);
+
+	if (parent)
+		Finish(parent);
+}
+
+void JobSystem::ReleaseDependency(Job* job)
+{
+	if (job->dependencies.fetch_sub(1) == 1)
+		Push(job);
+}
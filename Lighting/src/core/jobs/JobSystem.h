@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+#define MAX_JOBS_PER_WORKER 4096
+#define MAX_JOB_CONTINUATIONS 16
+
+// A unit of work. Jobs are allocated from per-worker rings and recycled after
+// MAX_JOBS_PER_WORKER allocations, do not keep pointers to them across frames.
+struct Job
+{
+	std::function<void()> function;
+	Job* parent;
+	std::atomic<int> unfinished;		// this job plus its children
+	std::atomic<int> dependencies;		// jobs that must finish first, plus one until Run
+	std::atomic<bool> lock;				// guards the continuation list
+	int continuationCount;
+	Job* continuations[MAX_JOB_CONTINUATIONS];
+};
+
+// Work-stealing thread pool. Every worker, the submitting thread included, owns a lock-free
+// deque: it pushes and pops its own jobs at the bottom while idle workers steal from the top.
+// Besides the workers, a single thread may create jobs (the simulation thread, or the main
+// thread when there is none), it acts as worker 0.
+// Jobs form a graph through children (a parent finishes after all of them) and
+// dependencies (a job starts only once the jobs it depends on have finished).
+class JobSystem
+{
+public:
+	static JobSystem& Get();
+
+	// workerThreads is the number of threads besides the submitting one, 0 means one per extra core
+	void Init(unsigned int workerThreads = 0);
+	void Shutdown();
+
+	// The job does not start before Run, children must be created while the parent is alive
+	Job* Create(std::function<void()> function, Job* parent = nullptr);
+	// job starts once dependency has finished, safe to call even if it already has
+	void AddDependency(Job* job, Job* dependency);
+	// Creates and runs a job that starts when job finishes
+	Job* Then(Job* job, std::function<void()> function);
+	void Run(Job* job);
+
+	// Runs other jobs on the calling thread until job has finished
+	void Wait(const Job* job);
+	inline bool IsComplete(const Job* job) const { return job->unfinished.load() == 0; }
+
+	// Splits [0, count) in batches of at least minBatchSize and calls function(begin, end) on each,
+	// the returned job finishes once every batch has run
+	template<typename F>
+	Job* ParallelFor(size_t count, size_t minBatchSize, F function, Job* parent = nullptr)
+	{
+		Job* root = Create(nullptr, parent);
+		root->function = [this, root, count, minBatchSize, function]()
+		{
+			RunBatches(root, count, minBatchSize, function);
+		};
+		return root;
+	}
+
+	// Same as ParallelFor from inside a running job, the batches become children of parent
+	template<typename F>
+	void RunBatches(Job* parent, size_t count, size_t minBatchSize, F function)
+	{
+		size_t batchSize = GetBatchSize(count, minBatchSize);
+		for (size_t begin = 0; begin < count; begin += batchSize)
+		{
+			size_t end = std::min(begin + batchSize, count);
+			Run(Create([function, begin, end]() { function(begin, end); }, parent));
+		}
+	}
+
+	// Size of the batches RunBatches splits count in, batch i starts at i * GetBatchSize
+	inline size_t GetBatchSize(size_t count, size_t minBatchSize) const
+	{
+		// A few batches per worker so stealing can even out uneven batches
+		size_t batches = GetWorkerCount() * 4;
+		return std::max<size_t>(std::max<size_t>(minBatchSize, 1), (count + batches - 1) / batches);
+	}
+
+	inline unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+
+private:
+	struct Worker
+	{
+		WorkStealingDeque<Job, MAX_JOBS_PER_WORKER> deque;
+		std::unique_ptr<Job[]> jobs;
+		size_t nextJob;
+		uint32_t random;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_Workers;		// 0 is the submitting thread
+	std::vector<std::thread> m_Threads;
+	std::atomic<bool> m_IsRunning;
+
+	// Idle workers sleep here until a job is queued, without any timeout
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeCondition;
+	std::atomic<unsigned int> m_SleepingCount;
+	std::atomic<int> m_QueuedCount;			// pushed and not taken yet, briefly negative when taken first
+
+private:
+	JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	static std::unique_ptr<Worker> CreateWorker(uint32_t seed);
+
+	void WorkerLoop(unsigned int index);
+	Worker& GetCurrentWorker();
+	Job* GetJob();
+	void Push(Job* job);
+	void Execute(Job* job);
+	void Finish(Job* job);
+	void ReleaseDependency(Job* job);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer handoff of whole values.
+// The producer fills the write buffer and publishes it, the consumer picks up the
+// latest published one. Neither side ever waits: the third buffer is the one in
+// between, swapped with an atomic exchange.
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : m_Middle(1), m_Write(0), m_Read(2) {}
+
+	// Producer only
+	inline T& GetWriteBuffer() { return m_Buffers[m_Write]; }
+
+	// Producer only, hands the write buffer over and takes the middle one in exchange
+	void Publish()
+	{
+		m_Write = m_Middle.exchange(m_Write | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Consumer only, returns false if nothing was published since the last call
+	bool Acquire()
+	{
+		if (!(m_Middle.load(std::memory_order_relaxed) & FRESH))
+			return false;
+
+		m_Read = m_Middle.exchange(m_Read, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	// Consumer only, stays valid until the next Acquire
+	inline const T& GetReadBuffer() const { return m_Buffers[m_Read]; }
+	inline T& GetReadBuffer() { return m_Buffers[m_Read]; }
+
+private:
+	static const uint8_t INDEX_MASK = 0x3;
+	static const uint8_t FRESH = 0x4;	// set by Publish, cleared by Acquire
+
+	T m_Buffers[3];
+	std::atomic<uint8_t> m_Middle;
+	uint8_t m_Write;
+	uint8_t m_Read;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free Chase-Lev deque of a fixed power of two capacity.
+// The owning thread pushes and pops at the bottom, other threads steal from the top.
+template<typename T, size_t Capacity>
+class WorkStealingDeque
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	WorkStealingDeque() : m_Top(0), m_Padding(), m_Bottom(0)
+	{
+		for (auto& item : m_Items)
+			item.store(nullptr, std::memory_order_relaxed);
+	}
+
+	// Owner only, returns false when the deque is full
+	bool Push(T* item)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= static_cast<int64_t>(Capacity))
+			return false;
+
+		m_Items[bottom & MASK].store(item, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Owner only, takes the most recently pushed item
+	T* Pop()
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T* item = m_Items[bottom & MASK].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last item, race the thieves for it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				item = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	// Any thread, takes the oldest item
+	T* Steal()
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		T* item = m_Items[top & MASK].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return item;
+	}
+
+private:
+	static const size_t MASK = Capacity - 1;
+
+	// Top and bottom on separate cache lines, they are written by different threads.
+	// Padding rather than alignas, over-aligned new is C++17.
+	std::atomic<int64_t> m_Top;
+	char m_Padding[64];
+	std::atomic<int64_t> m_Bottom;
+	std::atomic<T*> m_Items[Capacity];
+};
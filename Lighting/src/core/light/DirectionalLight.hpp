@@ -32,6 +32,13 @@ public:
 	inline glm::vec3 GetSpecular() const { return m_Specular; }
 	inline float GetIntensity() const { return m_Intensity; }
 
+	inline bool operator==(const DirectionalLight& other) const
+	{
+		return m_Direction == other.m_Direction && m_Color == other.m_Color && m_Ambient == other.m_Ambient &&
+			m_Diffuse == other.m_Diffuse && m_Specular == other.m_Specular && m_Intensity == other.m_Intensity;
+	}
+	inline bool operator!=(const DirectionalLight& other) const { return !(*this == other); }
+
 private:
 	glm::vec3 m_Direction;
 	glm::vec3 m_Color;
@@ -0,0 +1,109 @@
+#include "DrawList.h"
+
+#include <algorithm>
+
+void DrawList::Build(const FrameData& frame, const glm::mat4& view, const ResourceRegistry& resources)
+{
+	draws.clear();
+	pointLights.clear();
+	lightIndices.clear();
+	commands.clear();
+	cullInputs.clear();
+	groups.clear();
+	geometryIds.clear();
+	staleLightIndices = 0;
+
+	UpdateLights(frame, view);
+
+	for (const RenderItem& item : frame.renderItems)
+	{
+		// Material parameters live in the MaterialBuffer, draws only carry the row
+		unsigned int drawIndex = static_cast<unsigned int>(draws.size());
+		draws.push_back({ item.transformIndex, item.materialIndex, static_cast<unsigned int>(lightIndices.size()), item.lightCount, glm::vec4(item.color, 1.0f) });
+		lightIndices.insert(lightIndices.end(), item.lights, item.lights + item.lightCount);
+
+		// One instance, the base instance is only there to carry the draw index
+		const GeometryRange& range = item.mesh->GetGeometryRange();
+		commands.push_back({ range.indexCount, 1, range.firstIndex, range.baseVertex, drawIndex });
+		geometryIds.push_back(range.id);
+
+		// Light entities are drawn untextured, the layers come from the material buffer
+		unsigned int diffuseArray = item.isLight ? TEXTURE_ARRAY_NONE : resources.GetTextureLayer(item.material->GetDiffuseMap()).array;
+		unsigned int specularArray = item.isLight ? TEXTURE_ARRAY_NONE : resources.GetTextureLayer(item.material->GetSpecularMap()).array;
+		unsigned int emissionArray = item.isLight ? TEXTURE_ARRAY_NONE : resources.GetTextureLayer(item.material->GetEmissionMap()).array;
+
+		if (groups.empty() || groups.back().shader != item.shader || groups.back().diffuseArray != diffuseArray ||
+			groups.back().specularArray != specularArray || groups.back().emissionArray != emissionArray)
+		{
+			unsigned int features = (diffuseArray != TEXTURE_ARRAY_NONE ? SHADER_FEATURE_TEXTURED : 0) |
+				(emissionArray != TEXTURE_ARRAY_NONE ? SHADER_FEATURE_EMISSION : 0);
+			groups.push_back({ item.shader, diffuseArray, specularArray, emissionArray, features, drawIndex, 0 });
+		}
+		DrawGroup& group = groups.back();
+		group.commandCount++;
+
+		// The GPU decides whether the command is drawn, see cull.comp
+		cullInputs.push_back({ item.bounds, static_cast<unsigned int>(groups.size() - 1), group.firstCommand, { 0, 0 } });
+	}
+}
+
+void DrawList::UpdateLights(const FrameData& frame, const glm::mat4& view)
+{
+	pointLights.clear();
+
+	// Lighting is done in view space
+	for (const PointLightData& light : frame.pointLights)
+	{
+		glm::vec3 position = glm::vec3(view * glm::vec4(light.position, 1.0f));
+		pointLights.push_back({ glm::vec4(position, light.radius), glm::vec4(light.ambient, 0.0f), glm::vec4(light.diffuse, 0.0f), glm::vec4(light.specular, 0.0f) });
+	}
+}
+
+void DrawList::PatchDraw(unsigned int drawIndex, const glm::vec4& bounds, const unsigned int* lights, unsigned int lightCount)
+{
+	DrawData& draw = draws[drawIndex];
+	cullInputs[drawIndex].bounds = bounds;
+
+	// Fewer lights fit in the old range, more go at the end and leave it behind
+	if (lightCount > draw.lightCount)
+	{
+		staleLightIndices += draw.lightCount;
+		draw.lightOffset = static_cast<unsigned int>(lightIndices.size());
+		lightIndices.insert(lightIndices.end(), lights, lights + lightCount);
+	}
+	else
+	{
+		staleLightIndices += draw.lightCount - lightCount;
+		std::copy(lights, lights + lightCount, lightIndices.begin() + draw.lightOffset);
+	}
+	draw.lightCount = lightCount;
+
+	if (staleLightIndices * 2 > lightIndices.size())
+		CompactLightIndices();
+}
+
+void DrawList::PatchGeometry(const GeometryBuffer& geometry, unsigned int version)
+{
+	// A moved mesh keeps its size, only where it starts changes
+	for (size_t i = 0; i < commands.size(); i++)
+	{
+		const GeometryRange& range = geometry.GetRange(geometryIds[i]);
+		commands[i].firstIndex = range.firstIndex;
+		commands[i].baseVertex = range.baseVertex;
+	}
+	geometryVersion = version;
+}
+
+void DrawList::CompactLightIndices()
+{
+	std::vector<unsigned int> compacted;
+	compacted.reserve(lightIndices.size() - staleLightIndices);
+	for (DrawData& draw : draws)
+	{
+		unsigned int offset = static_cast<unsigned int>(compacted.size());
+		compacted.insert(compacted.end(), lightIndices.begin() + draw.lightOffset, lightIndices.begin() + draw.lightOffset + draw.lightCount);
+		draw.lightOffset = offset;
+	}
+	lightIndices.swap(compacted);
+	staleLightIndices = 0;
+}
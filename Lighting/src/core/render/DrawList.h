@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../ecs/Systems.h"
+#include "../geometry/GeometryBuffer.h"
+#include "../resource/ResourceRegistry.h"
+
+// Per-draw data, indexed with gl_BaseInstance (std430, see DrawData in the shaders)
+struct DrawData
+{
+	unsigned int transformIndex;
+	unsigned int materialIndex;		// row in the MaterialBuffer
+	unsigned int lightOffset;		// range in the light index buffer
+	unsigned int lightCount;
+	glm::vec4 color;				// emissive color of light entities
+};
+
+// std430, see PointLight in the shaders
+struct PointLightGpuData
+{
+	glm::vec4 position;				// view space, w is the radius
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+};
+
+// Layout read by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+// Input of the GPU culling pass, see CullData in cull.comp
+struct CullData
+{
+	glm::vec4 bounds;				// world space bounding sphere, w is the radius
+	unsigned int group;
+	unsigned int groupFirstCommand;
+	unsigned int padding[2];
+};
+
+// Consecutive commands sharing a program and texture arrays, submitted with one multi-draw.
+// Materials with different textures of the same size share a group.
+struct DrawGroup
+{
+	Shader* shader;
+	unsigned int diffuseArray;		// TextureArrayPool indices, TEXTURE_ARRAY_NONE when unused
+	unsigned int specularArray;
+	unsigned int emissionArray;
+	unsigned int features;			// SHADER_FEATURE_ bits the materials need, the frame adds its own
+	unsigned int firstCommand;
+	unsigned int commandCount;
+};
+
+// Turns the render items of a frame into the buffers of the indirect opaque pass.
+// Retained by the scene: built again only when objects, meshes, materials or shaders
+// change, patched in place when the camera or a transform does. Draw i comes from
+// render item i.
+struct DrawList
+{
+	std::vector<DrawData> draws;
+	std::vector<PointLightGpuData> pointLights;
+	std::vector<unsigned int> lightIndices;
+	std::vector<DrawElementsIndirectCommand> commands;	// every draw, culled on the GPU
+	std::vector<CullData> cullInputs;
+	std::vector<DrawGroup> groups;
+	std::vector<unsigned int> geometryIds;		// GeometryRange id of each command
+	size_t staleLightIndices = 0;	// left behind by PatchDraw, compacted past half the list
+	unsigned int geometryVersion = 0;	// Scene::m_GeometryVersion the command ranges match
+
+	// Render items must be sorted by shader and texture arrays for the groups to be large
+	void Build(const FrameData& frame, const glm::mat4& view, const ResourceRegistry& resources);
+	// Point light positions, they are in view space
+	void UpdateLights(const FrameData& frame, const glm::mat4& view);
+	// New bounds and lights of one draw, its group and command stay as they are
+	void PatchDraw(unsigned int drawIndex, const glm::vec4& bounds, const unsigned int* lights, unsigned int lightCount);
+	// Where the meshes are now, after the geometry was defragmented
+	void PatchGeometry(const GeometryBuffer& geometry, unsigned int version);
+
+private:
+	void CompactLightIndices();
+};
@@ -0,0 +1,40 @@
+#include "GpuBuffer.h"
+
+#include "../resource/GpuDeletionQueue.h"
+
+GpuBuffer::GpuBuffer() :
+	m_Id(0), m_Capacity(0)
+{
+}
+
+GpuBuffer::~GpuBuffer()
+{
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+}
+
+void GpuBuffer::Reserve(GLenum target, size_t size)
+{
+	if (m_Id == 0)
+		glGenBuffers(1, &m_Id);
+
+	glBindBuffer(target, m_Id);
+	if (size > m_Capacity)
+	{
+		glBufferData(target, size, nullptr, GL_DYNAMIC_DRAW);
+		m_Capacity = size;
+	}
+}
+
+void GpuBuffer::Clear(GLenum target, size_t size)
+{
+	if (size == 0)
+		return;
+
+	glBindBuffer(target, m_Id);
+	glClearBufferSubData(target, GL_R32UI, 0, size, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+void GpuBuffer::BindBase(GLenum target, unsigned int binding) const
+{
+	glBindBufferBase(target, binding, m_Id);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// GL buffer written by the GPU every frame, such as the culling output. It is reallocated
+// when the data outgrows it. Created on first use, it can exist before the GL context.
+// Data written by the CPU every frame goes through a RingBuffer instead.
+class GpuBuffer
+{
+public:
+	GpuBuffer();
+	~GpuBuffer();
+
+	GpuBuffer(const GpuBuffer&) = delete;
+	GpuBuffer& operator=(const GpuBuffer&) = delete;
+
+	// Makes room for size bytes written by the GPU, the content is undefined
+	void Reserve(GLenum target, size_t size);
+	// Zeroes the first size bytes, size must be a multiple of 4
+	void Clear(GLenum target, size_t size);
+	// Binds the buffer to an indexed target such as GL_SHADER_STORAGE_BUFFER
+	void BindBase(GLenum target, unsigned int binding) const;
+
+	inline unsigned int GetId() const { return m_Id; }
+
+private:
+	unsigned int m_Id;
+	size_t m_Capacity;
+};
@@ -0,0 +1,63 @@
+#include "MaterialBuffer.h"
+
+#include <glad/glad.h>
+
+#include "../resource/GpuDeletionQueue.h"
+
+MaterialBuffer::MaterialBuffer() :
+	m_Id(0), m_Capacity(0), m_UploadCount(0)
+{
+}
+
+MaterialBuffer::~MaterialBuffer()
+{
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+}
+
+void MaterialBuffer::Update(ResourceRegistry& resources)
+{
+	SlotMap<Material>& materials = resources.GetMaterials();
+	m_DirtyRows.clear();
+	for (size_t i = 0; i < materials.Size(); i++)
+	{
+		Material* material = materials.GetAt(i);
+		if (!material->IsDirty())
+			continue;
+
+		// Slots are stable for the lifetime of a material, a new one in a reused slot starts dirty
+		uint32_t row = materials.GetHandleAt(i).index;
+		if (row >= m_Rows.size())
+			m_Rows.resize(row + 1);
+
+		m_Rows[row] = { glm::vec4(material->GetAmbient(), 0.0f), glm::vec4(material->GetDiffuse(), 0.0f),
+			glm::vec4(material->GetSpecular(), material->GetShininess()),
+			glm::vec4(static_cast<float>(resources.GetTextureLayer(material->GetDiffuseMap()).layer), static_cast<float>(resources.GetTextureLayer(material->GetSpecularMap()).layer), static_cast<float>(resources.GetTextureLayer(material->GetEmissionMap()).layer), 0.0f) };
+		m_DirtyRows.push_back(row);
+		material->ClearDirty();
+	}
+
+	m_UploadCount = m_DirtyRows.size();
+	if (m_DirtyRows.empty())
+		return;
+
+	if (m_Id == 0)
+		glGenBuffers(1, &m_Id);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Id);
+
+	// A new slot reallocates the whole buffer, edits only rewrite their row
+	if (m_Rows.size() > m_Capacity)
+	{
+		m_Capacity = m_Rows.capacity();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_Capacity * sizeof(MaterialData), nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Rows.size() * sizeof(MaterialData), m_Rows.data());
+		return;
+	}
+
+	for (uint32_t row : m_DirtyRows)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, row * sizeof(MaterialData), sizeof(MaterialData), &m_Rows[row]);
+}
+
+void MaterialBuffer::BindBase(unsigned int binding) const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_Id);
+}
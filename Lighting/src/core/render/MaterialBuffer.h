@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../resource/ResourceRegistry.h"
+
+// std430, see MaterialData in the shaders
+struct MaterialData
+{
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;				// w is the shininess
+	glm::vec4 layers;				// diffuse, specular and emission layers in their texture arrays
+};
+
+// Parameters of every material in one SSBO, one row per material slot so draws index it
+// with the slot of their material handle. Only the materials edited since the last
+// Update are written. Created on first update, it can exist before the GL context.
+class MaterialBuffer
+{
+public:
+	MaterialBuffer();
+	~MaterialBuffer();
+
+	MaterialBuffer(const MaterialBuffer&) = delete;
+	MaterialBuffer& operator=(const MaterialBuffer&) = delete;
+
+	// On the thread owning the GL context, clears the dirty flags of the materials written
+	void Update(ResourceRegistry& resources);
+	void BindBase(unsigned int binding) const;
+
+	// Materials written by the last Update, and those left as they were
+	inline size_t GetUploadCount() const { return m_UploadCount; }
+	inline size_t GetSkipCount() const { return m_Rows.size() - m_UploadCount; }
+
+private:
+	unsigned int m_Id;
+	size_t m_Capacity;
+	std::vector<MaterialData> m_Rows;
+	std::vector<uint32_t> m_DirtyRows;
+	size_t m_UploadCount;
+};
@@ -0,0 +1,125 @@
+#include "RingBuffer.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "../resource/GpuDeletionQueue.h"
+
+// Smallest region, so a scene growing one object at a time does not reallocate every frame
+#define RING_BUFFER_MIN_REGION_SIZE (256 * 1024)
+
+RingBuffer::RingBuffer() :
+	m_Id(0), m_Data(nullptr), m_RegionSize(0), m_Alignment(0),
+	m_Region(0), m_Head(0)
+{
+	for (auto& fence : m_Fences)
+		fence = nullptr;
+}
+
+RingBuffer::~RingBuffer()
+{
+	for (auto& fence : m_Fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+	}
+
+	// Deleting a mapped buffer unmaps it
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+}
+
+void RingBuffer::BeginFrame(size_t size, size_t writeCount)
+{
+	if (m_Alignment == 0)
+	{
+		// Range bindings must start on this boundary, indirect commands only need 4 bytes
+		GLint alignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_Alignment = alignment > 4 ? static_cast<size_t>(alignment) : 4;
+	}
+
+	// Every write is padded to the alignment, an empty one still takes a slot to bind
+	size_t needed = size + writeCount * m_Alignment;
+	if (needed > m_RegionSize)
+	{
+		size_t regionSize = m_RegionSize > 0 ? m_RegionSize : RING_BUFFER_MIN_REGION_SIZE;
+		while (regionSize < needed)
+			regionSize *= 2;
+		Allocate(regionSize);
+	}
+
+	m_Region = (m_Region + 1) % RING_BUFFER_FRAMES;
+	WaitForRegion(m_Region);
+	m_Head = 0;
+}
+
+RingBuffer::Range RingBuffer::Write(const void* data, size_t size)
+{
+	Range range;
+	range.offset = m_Region * m_RegionSize + m_Head;
+	// glBindBufferRange does not take empty ranges
+	range.size = size > 0 ? size : m_Alignment;
+
+	assert(m_Head + range.size <= m_RegionSize && "Ring buffer region overflow, BeginFrame was given too small a size");
+	if (size > 0)
+		std::memcpy(m_Data + range.offset, data, size);
+
+	m_Head += (range.size + m_Alignment - 1) / m_Alignment * m_Alignment;
+	return range;
+}
+
+void RingBuffer::EndFrame()
+{
+	if (m_Id == 0)
+		return;
+
+	if (m_Fences[m_Region])
+		glDeleteSync(m_Fences[m_Region]);
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void RingBuffer::BindRange(GLenum target, unsigned int binding, const Range& range) const
+{
+	glBindBufferRange(target, binding, m_Id, static_cast<GLintptr>(range.offset), static_cast<GLsizeiptr>(range.size));
+}
+
+void RingBuffer::Allocate(size_t regionSize)
+{
+	// Frames in flight still read the previous buffer, the deletion queue waits for them
+	GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_Id);
+	for (auto& fence : m_Fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr size = static_cast<GLsizeiptr>(regionSize * RING_BUFFER_FRAMES);
+
+	glGenBuffers(1, &m_Id);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, m_Id);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+	m_Data = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+	m_RegionSize = regionSize;
+}
+
+void RingBuffer::WaitForRegion(unsigned int region)
+{
+	GLsync fence = m_Fences[region];
+	if (!fence)
+		return;
+
+	// Only blocks when the CPU is RING_BUFFER_FRAMES frames ahead
+	GLbitfield flags = 0;
+	while (true)
+	{
+		GLenum status = glClientWaitSync(fence, flags, 1000000);
+		if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED || status == GL_WAIT_FAILED)
+			break;
+		flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	}
+
+	glDeleteSync(fence);
+	m_Fences[region] = nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// Frames the CPU can write ahead of the GPU
+#define RING_BUFFER_FRAMES 3
+
+// Persistently mapped, coherent buffer for data rewritten every frame. It is split in
+// RING_BUFFER_FRAMES regions: the CPU writes one while the GPU reads the others, and
+// a fence per region keeps the CPU from overwriting a frame still in flight.
+// Created on the first BeginFrame, it can exist before the GL context.
+class RingBuffer
+{
+public:
+	struct Range
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	RingBuffer();
+	~RingBuffer();
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	// Waits for the GPU to release the next region. The region is grown if the frame
+	// needs more than size bytes spread over writeCount writes.
+	void BeginFrame(size_t size, size_t writeCount);
+	// Copies straight into the mapped region, no driver copy
+	Range Write(const void* data, size_t size);
+	// Fences the region written since BeginFrame
+	void EndFrame();
+
+	// Binds a range to an indexed target such as GL_SHADER_STORAGE_BUFFER
+	void BindRange(GLenum target, unsigned int binding, const Range& range) const;
+
+	inline unsigned int GetId() const { return m_Id; }
+	inline size_t GetRegionSize() const { return m_RegionSize; }
+
+private:
+	unsigned int m_Id;
+	unsigned char* m_Data;
+	size_t m_RegionSize;
+	size_t m_Alignment;
+
+	unsigned int m_Region;
+	size_t m_Head;
+	GLsync m_Fences[RING_BUFFER_FRAMES];
+
+private:
+	void Allocate(size_t regionSize);
+	void WaitForRegion(unsigned int region);
+};
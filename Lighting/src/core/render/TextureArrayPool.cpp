@@ -0,0 +1,104 @@
+#include "TextureArrayPool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "../resource/GpuDeletionQueue.h"
+
+TextureArrayPool::~TextureArrayPool()
+{
+	for (const TextureArray& array : m_Arrays)
+		GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::TEXTURE, array.id);
+}
+
+TextureLayer TextureArrayPool::Add(const Texture& texture)
+{
+	TextureLayer location;
+	if (texture.GetWidth() == 0 || texture.GetHeight() == 0)
+		return location;
+
+	// One array per size, every texture is RGB8 with a full mip chain
+	size_t index = 0;
+	while (index < m_Arrays.size() && (m_Arrays[index].width != texture.GetWidth() || m_Arrays[index].height != texture.GetHeight()))
+		index++;
+
+	if (index == m_Arrays.size())
+	{
+		TextureArray array;
+		array.id = 0;
+		array.width = texture.GetWidth();
+		array.height = texture.GetHeight();
+		array.levels = texture.GetLevelCount();
+		array.capacity = 0;
+		array.layerCount = 0;
+		Allocate(array, TEXTURE_ARRAY_INITIAL_LAYERS);
+		m_Arrays.push_back(std::move(array));
+	}
+
+	TextureArray& array = m_Arrays[index];
+	unsigned int layer;
+	if (!array.freeLayers.empty())
+	{
+		layer = array.freeLayers.back();
+		array.freeLayers.pop_back();
+	}
+	else
+	{
+		if (array.layerCount == array.capacity)
+			Allocate(array, array.capacity * 2);
+		layer = array.layerCount++;
+	}
+
+	for (int level = 0; level < array.levels; level++)
+	{
+		int width = std::max(array.width >> level, 1);
+		int height = std::max(array.height >> level, 1);
+		glCopyImageSubData(texture.GetTexture(), GL_TEXTURE_2D, level, 0, 0, 0,
+			array.id, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1);
+	}
+
+	location.array = static_cast<unsigned int>(index);
+	location.layer = layer;
+	return location;
+}
+
+void TextureArrayPool::Remove(const TextureLayer& layer)
+{
+	if (layer.array != TEXTURE_ARRAY_NONE)
+		m_Arrays[layer.array].freeLayers.push_back(layer.layer);
+}
+
+void TextureArrayPool::Bind(unsigned int array, unsigned int unit) const
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, array != TEXTURE_ARRAY_NONE ? m_Arrays[array].id : 0);
+}
+
+void TextureArrayPool::Allocate(TextureArray& array, unsigned int capacity)
+{
+	unsigned int id;
+	glGenTextures(1, &id);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, array.levels, GL_RGB8, array.width, array.height, capacity);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// Frames in flight still sample the previous array, the deletion queue waits for them
+	if (array.id != 0)
+	{
+		for (int level = 0; level < array.levels; level++)
+		{
+			int width = std::max(array.width >> level, 1);
+			int height = std::max(array.height >> level, 1);
+			glCopyImageSubData(array.id, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				id, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, width, height, array.layerCount);
+		}
+		GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::TEXTURE, array.id);
+	}
+
+	array.id = id;
+	array.capacity = capacity;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "../Texture.h"
+
+// Layers of a new array, it doubles when full
+#define TEXTURE_ARRAY_INITIAL_LAYERS 4
+
+// Textures of the same size in GL_TEXTURE_2D_ARRAYs, so draws whose materials use
+// different textures can share one set of bindings. Each texture is copied into a
+// layer of the array matching its size, the material buffer carries the layers.
+class TextureArrayPool
+{
+public:
+	TextureArrayPool() = default;
+	~TextureArrayPool();
+
+	TextureArrayPool(const TextureArrayPool&) = delete;
+	TextureArrayPool& operator=(const TextureArrayPool&) = delete;
+
+	// Copies the texture on the GPU, on the thread owning the GL context
+	TextureLayer Add(const Texture& texture);
+	void Remove(const TextureLayer& layer);
+
+	// Binds the array to the texture unit, unbinds it for TEXTURE_ARRAY_NONE
+	void Bind(unsigned int array, unsigned int unit) const;
+
+	inline size_t GetArrayCount() const { return m_Arrays.size(); }
+
+private:
+	struct TextureArray
+	{
+		unsigned int id;
+		int width;
+		int height;
+		int levels;
+		unsigned int capacity;
+		unsigned int layerCount;		// layers ever used, the free ones are in freeLayers
+		std::vector<unsigned int> freeLayers;
+	};
+
+	std::vector<TextureArray> m_Arrays;
+
+private:
+	void Allocate(TextureArray& array, unsigned int capacity);
+};
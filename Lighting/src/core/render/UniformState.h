@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Directional light as the shaders receive it, in view space
+struct DirLightState
+{
+	glm::vec3 direction;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+
+	bool operator==(const DirLightState& other) const
+	{
+		return direction == other.direction && ambient == other.ambient && diffuse == other.diffuse && specular == other.specular;
+	}
+};
+
+// Flashlight, fixed to the camera
+struct SpotLightState
+{
+	glm::vec3 direction;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+	float cutOff;
+	float outerCutOff;
+
+	bool operator==(const SpotLightState& other) const
+	{
+		return direction == other.direction && ambient == other.ambient && diffuse == other.diffuse &&
+			specular == other.specular && cutOff == other.cutOff && outerCutOff == other.outerCutOff;
+	}
+};
+
+// Value of a uniform block with a version bumped whenever it changes. Programs remember
+// the version they last received, see Shader::ShouldUpload. Version 0 is never used.
+template<typename T>
+class VersionedState
+{
+public:
+	VersionedState() : m_Value(), m_Version(0) {}
+
+	// Same values keep the version, so programs holding them skip the upload
+	void Set(const T& value)
+	{
+		if (m_Version != 0 && value == m_Value)
+			return;
+		m_Value = value;
+		m_Version++;
+	}
+
+	inline const T& Get() const { return m_Value; }
+	inline unsigned int GetVersion() const { return m_Version; }
+
+private:
+	T m_Value;
+	unsigned int m_Version;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Typed generational handle into a SlotMap<T>. A handle to a removed resource
+// never resolves, even after its slot is reused.
+template<typename T>
+struct Handle
+{
+	uint32_t index;
+	uint32_t generation;
+
+	static const uint32_t INVALID_INDEX = ~0u;
+
+	Handle() : index(INVALID_INDEX), generation(0) {}
+	Handle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+	inline bool IsValid() const { return index != INVALID_INDEX; }
+
+	inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+	inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+class Mesh;
+class Material;
+class Shader;
+class Texture;
+
+typedef Handle<Mesh> MeshHandle;
+typedef Handle<Material> MaterialHandle;
+typedef Handle<Shader> ShaderHandle;
+typedef Handle<Texture> TextureHandle;
@@ -0,0 +1,162 @@
+#include "ProgramCache.h"
+
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIRECTORY(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIRECTORY(path) mkdir(path, 0755)
+#endif
+
+// Start of every cache file, bumped when the layout changes
+#define PROGRAM_CACHE_MAGIC 0x31425250u
+
+struct ProgramCacheHeader
+{
+	uint32_t magic;
+	uint32_t format;
+	uint32_t size;
+};
+
+// FNV-1a, stable across runs and compilers unlike std::hash
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static std::string GetString(GLenum name)
+{
+	const GLubyte* value = glGetString(name);
+	return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+ProgramCache& ProgramCache::Get()
+{
+	static ProgramCache instance;
+	return instance;
+}
+
+ProgramCache::ProgramCache() :
+	m_Initialized(false), m_Supported(false), m_Hits(0), m_Misses(0)
+{
+}
+
+void ProgramCache::Initialize()
+{
+	if (m_Initialized)
+		return;
+	m_Initialized = true;
+
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	m_Supported = formatCount > 0;
+	m_Driver = GetString(GL_VENDOR) + "|" + GetString(GL_RENDERER) + "|" + GetString(GL_VERSION);
+
+	// Fails harmlessly when the directories already exist
+	MAKE_DIRECTORY("cache");
+	MAKE_DIRECTORY(PROGRAM_CACHE_DIRECTORY);
+}
+
+uint64_t ProgramCache::MakeKey(const std::string* sources, size_t count)
+{
+	Initialize();
+
+	uint64_t hash = HashBytes(0xcbf29ce484222325ull, m_Driver.data(), m_Driver.size());
+	for (size_t i = 0; i < count; i++)
+	{
+		// The length separates the stages, "ab" + "c" must not match "a" + "bc"
+		uint64_t size = sources[i].size();
+		hash = HashBytes(hash, &size, sizeof(size));
+		hash = HashBytes(hash, sources[i].data(), sources[i].size());
+	}
+	return hash;
+}
+
+unsigned int ProgramCache::Load(uint64_t key)
+{
+	Initialize();
+	if (!m_Supported)
+		return 0;
+
+	std::ifstream file(GetPath(key), std::ios::binary);
+	ProgramCacheHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != PROGRAM_CACHE_MAGIC)
+	{
+		m_Misses++;
+		return 0;
+	}
+
+	// A truncated or corrupt header must not size the allocation
+	std::streamoff start = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff remaining = file.tellg() - start;
+	file.seekg(start);
+	if (remaining < 0 || static_cast<uint64_t>(remaining) != header.size)
+	{
+		m_Misses++;
+		return 0;
+	}
+
+	std::vector<char> binary(header.size);
+	if (!file.read(binary.data(), binary.size()))
+	{
+		m_Misses++;
+		return 0;
+	}
+
+	unsigned int program = glCreateProgram();
+	glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	// The driver may refuse a binary even with matching strings, the caller then compiles
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(program);
+		m_Misses++;
+		return 0;
+	}
+
+	m_Hits++;
+	return program;
+}
+
+void ProgramCache::Save(uint64_t key, unsigned int program)
+{
+	Initialize();
+	if (!m_Supported)
+		return;
+
+	int success, length = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (!success || length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	ProgramCacheHeader header = { PROGRAM_CACHE_MAGIC, format, static_cast<uint32_t>(length) };
+	std::ofstream file(GetPath(key), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(binary.data(), length);
+}
+
+std::string ProgramCache::GetPath(uint64_t key) const
+{
+	static const char digits[] = "0123456789abcdef";
+	std::string name(16, '0');
+	for (int i = 15; i >= 0; i--, key >>= 4)
+		name[i] = digits[key & 0xf];
+	return std::string(PROGRAM_CACHE_DIRECTORY) + "/" + name + ".bin";
+}
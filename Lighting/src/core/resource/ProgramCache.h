@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Relative to the working directory, like res/
+#define PROGRAM_CACHE_DIRECTORY "cache/shaders"
+
+// Keeps linked program binaries on disk so later launches skip compiling and linking.
+// Keys hash the sources with the driver strings: after a driver update every lookup
+// misses instead of loading binaries the new driver may reject.
+class ProgramCache
+{
+public:
+	static ProgramCache& Get();
+
+	// Hash of the final sources, defines included. Needs a current context.
+	uint64_t MakeKey(const std::string* sources, size_t count);
+
+	// Program linked from the saved binary, 0 on a miss or when the driver rejects it
+	unsigned int Load(uint64_t key);
+	// The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	void Save(uint64_t key, unsigned int program);
+
+	inline size_t GetHitCount() const { return m_Hits; }
+	inline size_t GetMissCount() const { return m_Misses; }
+
+private:
+	bool m_Initialized;
+	bool m_Supported;	// drivers may expose no binary format at all
+	std::string m_Driver;
+	size_t m_Hits;
+	size_t m_Misses;
+
+private:
+	ProgramCache();
+	ProgramCache(const ProgramCache&) = delete;
+	ProgramCache& operator=(const ProgramCache&) = delete;
+
+	void Initialize();
+	std::string GetPath(uint64_t key) const;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SlotMap.h"
+#include "../geometry/Mesh.h"
+#include "../Material.hpp"
+#include "../Shader.h"
+#include "../Texture.h"
+
+// Owns the scene resources. Everything else refers to them by handle, so removing
+// one leaves stale handles behind instead of dangling pointers.
+class ResourceRegistry
+{
+public:
+	inline SlotMap<Mesh>& GetMeshes() { return m_Meshes; }
+	inline SlotMap<Material>& GetMaterials() { return m_Materials; }
+	inline SlotMap<Shader>& GetShaders() { return m_Shaders; }
+	inline SlotMap<Texture>& GetTextures() { return m_Textures; }
+	inline const SlotMap<Material>& GetMaterials() const { return m_Materials; }
+
+	inline Mesh* Get(MeshHandle handle) const { return m_Meshes.Get(handle); }
+	inline Material* Get(MaterialHandle handle) const { return m_Materials.Get(handle); }
+	inline Shader* Get(ShaderHandle handle) const { return m_Shaders.Get(handle); }
+	inline Texture* Get(TextureHandle handle) const { return m_Textures.Get(handle); }
+
+	// Where the texture was pooled, TEXTURE_ARRAY_NONE for stale handles
+	inline const TextureLayer& GetTextureLayer(TextureHandle handle) const
+	{
+		static const TextureLayer none;
+		Texture* texture = m_Textures.Get(handle);
+		return texture ? texture->GetLayer() : none;
+	}
+
+private:
+	SlotMap<Mesh> m_Meshes;
+	SlotMap<Material> m_Materials;
+	SlotMap<Shader> m_Shaders;
+	SlotMap<Texture> m_Textures;
+};
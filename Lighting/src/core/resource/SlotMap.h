@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Handle.h"
+
+// Resources packed in a dense array with a sparse slot table in front of it.
+// Add, Remove and Get are O(1), iteration walks the dense array only.
+// Values are heap allocated so pointers to them stay valid while they are alive.
+template<typename T>
+class SlotMap
+{
+public:
+	typedef typename std::vector<std::unique_ptr<T>>::iterator Iterator;
+	typedef typename std::vector<std::unique_ptr<T>>::const_iterator ConstIterator;
+
+	Handle<T> Add(std::unique_ptr<T> value)
+	{
+		uint32_t slot;
+		if (!m_FreeSlots.empty())
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(m_Slots.size());
+			m_Slots.push_back({ 0, 0 });
+		}
+
+		m_Slots[slot].denseIndex = static_cast<uint32_t>(m_Values.size());
+		m_Values.push_back(std::move(value));
+		m_DenseToSlot.push_back(slot);
+
+		return Handle<T>(slot, m_Slots[slot].generation);
+	}
+
+	// Returns false when the handle is stale
+	bool Remove(Handle<T> handle)
+	{
+		if (!Contains(handle))
+			return false;
+
+		// The last value takes the place of the removed one
+		uint32_t dense = m_Slots[handle.index].denseIndex;
+		uint32_t last = static_cast<uint32_t>(m_Values.size() - 1);
+		if (dense != last)
+		{
+			m_Values[dense] = std::move(m_Values[last]);
+			m_DenseToSlot[dense] = m_DenseToSlot[last];
+			m_Slots[m_DenseToSlot[dense]].denseIndex = dense;
+		}
+		m_Values.pop_back();
+		m_DenseToSlot.pop_back();
+
+		m_Slots[handle.index].generation++;
+		m_Slots[handle.index].denseIndex = INVALID_DENSE;
+		m_FreeSlots.push_back(handle.index);
+		return true;
+	}
+
+	inline bool Contains(Handle<T> handle) const
+	{
+		return handle.index < m_Slots.size()
+			&& m_Slots[handle.index].generation == handle.generation
+			&& m_Slots[handle.index].denseIndex != INVALID_DENSE;
+	}
+
+	// nullptr for stale handles
+	inline T* Get(Handle<T> handle) const
+	{
+		return Contains(handle) ? m_Values[m_Slots[handle.index].denseIndex].get() : nullptr;
+	}
+
+	// Dense access, the order changes when values are removed
+	inline size_t Size() const { return m_Values.size(); }
+	inline bool Empty() const { return m_Values.empty(); }
+	inline T* GetAt(size_t dense) const { return m_Values[dense].get(); }
+	inline Handle<T> GetHandleAt(size_t dense) const
+	{
+		uint32_t slot = m_DenseToSlot[dense];
+		return Handle<T>(slot, m_Slots[slot].generation);
+	}
+
+	// Dense position of the handle, -1 when it is stale
+	inline int IndexOf(Handle<T> handle) const
+	{
+		return Contains(handle) ? static_cast<int>(m_Slots[handle.index].denseIndex) : -1;
+	}
+
+	inline Iterator begin() { return m_Values.begin(); }
+	inline Iterator end() { return m_Values.end(); }
+	inline ConstIterator begin() const { return m_Values.begin(); }
+	inline ConstIterator end() const { return m_Values.end(); }
+
+private:
+	struct Slot
+	{
+		uint32_t denseIndex;
+		uint32_t generation;
+	};
+
+	static const uint32_t INVALID_DENSE = ~0u;
+
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+	std::vector<std::unique_ptr<T>> m_Values;
+	std::vector<uint32_t> m_DenseToSlot;
+};
@@ -14,6 +14,9 @@ public:
         m_LastTime = currentTime;
     }
 
+    // Time that is not part of a frame, such as waiting for events
+    void Skip(float duration) { m_LastTime += duration; }
+
     inline double GetFPS() { return 1 / m_DeltaTime; }
     inline double GetMSPF() { return m_DeltaTime * 1000; }
     inline float GetDeltaTime() { return m_DeltaTime; }
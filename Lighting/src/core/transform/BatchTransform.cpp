@@ -0,0 +1,149 @@
+#include "BatchTransform.h"
+
+#include "BatchTransformKernels.h"
+
+#include <cstring>
+
+#if defined(BATCH_TRANSFORM_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	struct ScalarOps
+	{
+		typedef float Vec;
+		static const size_t WIDTH = 1;
+
+		static inline Vec Set1(float value) { return value; }
+		static inline Vec Load(const float* data) { return *data; }
+		static inline Vec Add(Vec a, Vec b) { return a + b; }
+		static inline Vec Sub(Vec a, Vec b) { return a - b; }
+		static inline Vec Mul(Vec a, Vec b) { return a * b; }
+		static inline Vec Div(Vec a, Vec b) { return a / b; }
+
+		static inline void Store(const Vec* result, float* outputs)
+		{
+			std::memcpy(outputs, result, BATCH_TRANSFORM_OUTPUT_FLOATS * sizeof(float));
+		}
+	};
+
+#include "BatchTransformKernel.inl"
+
+	typedef size_t (*KernelFunction)(const BatchTransformParams&, size_t, size_t);
+
+	struct Kernel
+	{
+		KernelFunction function;
+		const char* name;
+	};
+
+#if defined(BATCH_TRANSFORM_X86)
+	bool IsAVX2Supported()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		// The OS must also save the YMM registers on context switches
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	Kernel SelectKernel()
+	{
+#if defined(BATCH_TRANSFORM_X86)
+		if (IsAVX2Supported())
+			return { BatchTransformAVX2, "AVX2" };
+		return { BatchTransformSSE, "SSE" };
+#elif defined(BATCH_TRANSFORM_NEON)
+		return { BatchTransformNEON, "NEON" };
+#else
+		return { BatchTransformScalar, "Scalar" };
+#endif
+	}
+
+	const Kernel& GetKernel()
+	{
+		static const Kernel kernel = SelectKernel();
+		return kernel;
+	}
+}
+
+size_t BatchTransformScalar(const BatchTransformParams& params, size_t begin, size_t end)
+{
+	return RunBatchTransform<ScalarOps>(params, begin, end);
+}
+
+void TransformInputs::Clear()
+{
+	positionX.clear(); positionY.clear(); positionZ.clear();
+	rotationX.clear(); rotationY.clear(); rotationZ.clear(); rotationW.clear();
+	scaleX.clear(); scaleY.clear(); scaleZ.clear();
+}
+
+void TransformInputs::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	positionX.push_back(position.x); positionY.push_back(position.y); positionZ.push_back(position.z);
+	rotationX.push_back(rotation.x); rotationY.push_back(rotation.y); rotationZ.push_back(rotation.z); rotationW.push_back(rotation.w);
+	scaleX.push_back(scale.x); scaleY.push_back(scale.y); scaleZ.push_back(scale.z);
+}
+
+void TransformInputs::Set(size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	positionX[index] = position.x; positionY[index] = position.y; positionZ[index] = position.z;
+	rotationX[index] = rotation.x; rotationY[index] = rotation.y; rotationZ[index] = rotation.z; rotationW[index] = rotation.w;
+	scaleX[index] = scale.x; scaleY[index] = scale.y; scaleZ[index] = scale.z;
+}
+
+void BatchTransform::Compute(const TransformInputs& inputs, const glm::mat4& view, const glm::mat4& projection, std::vector<ObjectTransform>& outputs)
+{
+	const size_t count = inputs.GetCount();
+	outputs.resize(count);
+	if (count == 0)
+		return;
+
+	ComputeRange(inputs, view, projection, outputs.data(), 0, count);
+}
+
+void BatchTransform::ComputeRange(const TransformInputs& inputs, const glm::mat4& view, const glm::mat4& projection, ObjectTransform* outputs, size_t begin, size_t end)
+{
+	BatchTransformParams params;
+	params.positionX = inputs.positionX.data();
+	params.positionY = inputs.positionY.data();
+	params.positionZ = inputs.positionZ.data();
+	params.rotationX = inputs.rotationX.data();
+	params.rotationY = inputs.rotationY.data();
+	params.rotationZ = inputs.rotationZ.data();
+	params.rotationW = inputs.rotationW.data();
+	params.scaleX = inputs.scaleX.data();
+	params.scaleY = inputs.scaleY.data();
+	params.scaleZ = inputs.scaleZ.data();
+
+	glm::mat4 viewProjection = projection * view;
+	std::memcpy(params.view, &view[0][0], sizeof(params.view));
+	std::memcpy(params.viewProjection, &viewProjection[0][0], sizeof(params.viewProjection));
+
+	params.outputs = &outputs[0].world[0][0];
+
+	size_t done = GetKernel().function(params, begin, end);
+	BatchTransformScalar(params, done, end);
+}
+
+const char* BatchTransform::GetKernelName()
+{
+	return GetKernel().name;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Per-object matrices as laid out in the ObjectTransforms SSBO (std430)
+struct ObjectTransform
+{
+	glm::mat4 world;
+	glm::mat4 mvp;
+	glm::vec4 normal[3];		// view space normal matrix, one column per vec4
+};
+
+static_assert(sizeof(ObjectTransform) == 176, "ObjectTransform must match the std430 layout in the shaders");
+
+// Structure of arrays input, one entry per object
+struct TransformInputs
+{
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+
+	void Clear();
+	void Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void Set(size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	inline size_t GetCount() const { return positionX.size(); }
+};
+
+// Computes world, MVP and normal matrices for all objects in one pass, using the
+// widest SIMD kernel the CPU supports (AVX2, SSE, NEON or scalar)
+class BatchTransform
+{
+public:
+	static void Compute(const TransformInputs& inputs, const glm::mat4& view, const glm::mat4& projection, std::vector<ObjectTransform>& outputs);
+	// Computes [begin, end) only, outputs must already hold inputs.GetCount() elements
+	static void ComputeRange(const TransformInputs& inputs, const glm::mat4& view, const glm::mat4& projection, ObjectTransform* outputs, size_t begin, size_t end);
+
+	static const char* GetKernelName();
+};
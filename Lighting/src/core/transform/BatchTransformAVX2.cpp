@@ -0,0 +1,58 @@
+#include "BatchTransformKernels.h"
+
+#if defined(BATCH_TRANSFORM_X86)
+
+// Only called after BatchTransform checked for AVX2 support at runtime.
+// MSVC builds this file with /arch:AVX2 (see the vcxproj), GCC and Clang need the pragma.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+
+namespace
+{
+	struct AVX2Ops
+	{
+		typedef __m256 Vec;
+		static const size_t WIDTH = 8;
+
+		static inline Vec Set1(float value) { return _mm256_set1_ps(value); }
+		static inline Vec Load(const float* data) { return _mm256_loadu_ps(data); }
+		static inline Vec Add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+		static inline Vec Sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+		static inline Vec Mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+		static inline Vec Div(Vec a, Vec b) { return _mm256_div_ps(a, b); }
+
+		// Same 4x4 transposes as the SSE kernel, once for each 128-bit half
+		static inline void Store(const Vec* result, float* outputs)
+		{
+			for (int group = 0; group < BATCH_TRANSFORM_OUTPUT_FLOATS / 4; group++)
+			{
+				for (int half = 0; half < 2; half++)
+				{
+					__m128 r0 = half ? _mm256_extractf128_ps(result[group * 4 + 0], 1) : _mm256_castps256_ps128(result[group * 4 + 0]);
+					__m128 r1 = half ? _mm256_extractf128_ps(result[group * 4 + 1], 1) : _mm256_castps256_ps128(result[group * 4 + 1]);
+					__m128 r2 = half ? _mm256_extractf128_ps(result[group * 4 + 2], 1) : _mm256_castps256_ps128(result[group * 4 + 2]);
+					__m128 r3 = half ? _mm256_extractf128_ps(result[group * 4 + 3], 1) : _mm256_castps256_ps128(result[group * 4 + 3]);
+					_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+					float* base = outputs + half * 4 * BATCH_TRANSFORM_OUTPUT_FLOATS + group * 4;
+					_mm_storeu_ps(base + 0 * BATCH_TRANSFORM_OUTPUT_FLOATS, r0);
+					_mm_storeu_ps(base + 1 * BATCH_TRANSFORM_OUTPUT_FLOATS, r1);
+					_mm_storeu_ps(base + 2 * BATCH_TRANSFORM_OUTPUT_FLOATS, r2);
+					_mm_storeu_ps(base + 3 * BATCH_TRANSFORM_OUTPUT_FLOATS, r3);
+				}
+			}
+		}
+	};
+
+#include "BatchTransformKernel.inl"
+}
+
+size_t BatchTransformAVX2(const BatchTransformParams& params, size_t begin, size_t end)
+{
+	return RunBatchTransform<AVX2Ops>(params, begin, end);
+}
+
+#endif
@@ -0,0 +1,99 @@
+// Width agnostic transform kernel, included by every BatchTransform*.cpp.
+// Ops provides the vector type and Set1/Load/Add/Sub/Mul/Div/Store for one instruction set.
+// Each lane is one object, so every matrix element below is computed for WIDTH objects at once.
+
+template<typename Ops>
+size_t RunBatchTransform(const BatchTransformParams& params, size_t begin, size_t end)
+{
+	typedef typename Ops::Vec Vec;
+
+	Vec viewProjection[16];
+	for (int i = 0; i < 16; i++)
+		viewProjection[i] = Ops::Set1(params.viewProjection[i]);
+
+	// Upper 3x3 of the view matrix, column major
+	Vec view[9];
+	for (int c = 0; c < 3; c++)
+		for (int r = 0; r < 3; r++)
+			view[c * 3 + r] = Ops::Set1(params.view[c * 4 + r]);
+
+	const Vec zero = Ops::Set1(0.0f);
+	const Vec one = Ops::Set1(1.0f);
+	const Vec two = Ops::Set1(2.0f);
+
+	size_t i = begin;
+	for (; i + Ops::WIDTH <= end; i += Ops::WIDTH)
+	{
+		Vec qx = Ops::Load(params.rotationX + i);
+		Vec qy = Ops::Load(params.rotationY + i);
+		Vec qz = Ops::Load(params.rotationZ + i);
+		Vec qw = Ops::Load(params.rotationW + i);
+
+		Vec scale[3] = { Ops::Load(params.scaleX + i), Ops::Load(params.scaleY + i), Ops::Load(params.scaleZ + i) };
+
+		// Rotation matrix from the unit quaternion, column major
+		Vec xx = Ops::Mul(qx, qx), yy = Ops::Mul(qy, qy), zz = Ops::Mul(qz, qz);
+		Vec xy = Ops::Mul(qx, qy), xz = Ops::Mul(qx, qz), yz = Ops::Mul(qy, qz);
+		Vec wx = Ops::Mul(qw, qx), wy = Ops::Mul(qw, qy), wz = Ops::Mul(qw, qz);
+
+		Vec rotation[9];
+		rotation[0] = Ops::Sub(one, Ops::Mul(two, Ops::Add(yy, zz)));
+		rotation[1] = Ops::Mul(two, Ops::Add(xy, wz));
+		rotation[2] = Ops::Mul(two, Ops::Sub(xz, wy));
+		rotation[3] = Ops::Mul(two, Ops::Sub(xy, wz));
+		rotation[4] = Ops::Sub(one, Ops::Mul(two, Ops::Add(xx, zz)));
+		rotation[5] = Ops::Mul(two, Ops::Add(yz, wx));
+		rotation[6] = Ops::Mul(two, Ops::Add(xz, wy));
+		rotation[7] = Ops::Mul(two, Ops::Sub(yz, wx));
+		rotation[8] = Ops::Sub(one, Ops::Mul(two, Ops::Add(xx, yy)));
+
+		Vec result[BATCH_TRANSFORM_OUTPUT_FLOATS];
+		Vec* world = result;
+		Vec* mvp = result + 16;
+		Vec* normal = result + 32;
+
+		// World = T * R * S
+		for (int c = 0; c < 3; c++)
+		{
+			for (int r = 0; r < 3; r++)
+				world[c * 4 + r] = Ops::Mul(rotation[c * 3 + r], scale[c]);
+			world[c * 4 + 3] = zero;
+		}
+		world[12] = Ops::Load(params.positionX + i);
+		world[13] = Ops::Load(params.positionY + i);
+		world[14] = Ops::Load(params.positionZ + i);
+		world[15] = one;
+
+		// MVP = VP * World, the last row of World is known to be (0, 0, 0, 1)
+		for (int c = 0; c < 4; c++)
+		{
+			for (int r = 0; r < 4; r++)
+			{
+				Vec sum = Ops::Mul(viewProjection[r], world[c * 4 + 0]);
+				sum = Ops::Add(sum, Ops::Mul(viewProjection[4 + r], world[c * 4 + 1]));
+				sum = Ops::Add(sum, Ops::Mul(viewProjection[8 + r], world[c * 4 + 2]));
+				if (c == 3)
+					sum = Ops::Add(sum, viewProjection[12 + r]);
+				mvp[c * 4 + r] = sum;
+			}
+		}
+
+		// inverse(transpose(V * R * S)) reduces to V * R * S^-1 since V and R are orthonormal
+		for (int c = 0; c < 3; c++)
+		{
+			Vec inverseScale = Ops::Div(one, scale[c]);
+			for (int r = 0; r < 3; r++)
+			{
+				Vec sum = Ops::Mul(view[r], rotation[c * 3 + 0]);
+				sum = Ops::Add(sum, Ops::Mul(view[3 + r], rotation[c * 3 + 1]));
+				sum = Ops::Add(sum, Ops::Mul(view[6 + r], rotation[c * 3 + 2]));
+				normal[c * 4 + r] = Ops::Mul(sum, inverseScale);
+			}
+			normal[c * 4 + 3] = zero;
+		}
+
+		Ops::Store(result, params.outputs + i * BATCH_TRANSFORM_OUTPUT_FLOATS);
+	}
+
+	return i;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+
+// Kernel interface kept free of glm and the standard library on purpose: the
+// AVX2 kernel is compiled with AVX2 enabled, and any inline function it shared
+// with the rest of the program could end up being the copy the linker keeps.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BATCH_TRANSFORM_X86
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define BATCH_TRANSFORM_NEON
+#endif
+
+// Floats written per object: world (16), mvp (16), normal (3 x 4)
+#define BATCH_TRANSFORM_OUTPUT_FLOATS 44
+
+struct BatchTransformParams
+{
+	const float* positionX;
+	const float* positionY;
+	const float* positionZ;
+	const float* rotationX;
+	const float* rotationY;
+	const float* rotationZ;
+	const float* rotationW;
+	const float* scaleX;
+	const float* scaleY;
+	const float* scaleZ;
+
+	float view[16];				// column major
+	float viewProjection[16];	// column major
+
+	float* outputs;
+};
+
+// Each kernel processes whole SIMD batches from begin and returns where it stopped,
+// the remaining objects are left to the scalar kernel
+size_t BatchTransformScalar(const BatchTransformParams& params, size_t begin, size_t end);
+
+#if defined(BATCH_TRANSFORM_X86)
+size_t BatchTransformSSE(const BatchTransformParams& params, size_t begin, size_t end);
+size_t BatchTransformAVX2(const BatchTransformParams& params, size_t begin, size_t end);
+#elif defined(BATCH_TRANSFORM_NEON)
+size_t BatchTransformNEON(const BatchTransformParams& params, size_t begin, size_t end);
+#endif
@@ -0,0 +1,46 @@
+#include "BatchTransformKernels.h"
+
+#if defined(BATCH_TRANSFORM_NEON)
+
+#include <arm_neon.h>
+
+namespace
+{
+	struct NEONOps
+	{
+		typedef float32x4_t Vec;
+		static const size_t WIDTH = 4;
+
+		static inline Vec Set1(float value) { return vdupq_n_f32(value); }
+		static inline Vec Load(const float* data) { return vld1q_f32(data); }
+		static inline Vec Add(Vec a, Vec b) { return vaddq_f32(a, b); }
+		static inline Vec Sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+		static inline Vec Mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+		static inline Vec Div(Vec a, Vec b) { return vdivq_f32(a, b); }
+
+		static inline void Store(const Vec* result, float* outputs)
+		{
+			for (int group = 0; group < BATCH_TRANSFORM_OUTPUT_FLOATS / 4; group++)
+			{
+				// 4x4 transpose
+				float32x4x2_t t01 = vtrnq_f32(result[group * 4 + 0], result[group * 4 + 1]);
+				float32x4x2_t t23 = vtrnq_f32(result[group * 4 + 2], result[group * 4 + 3]);
+
+				float* base = outputs + group * 4;
+				vst1q_f32(base + 0 * BATCH_TRANSFORM_OUTPUT_FLOATS, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+				vst1q_f32(base + 1 * BATCH_TRANSFORM_OUTPUT_FLOATS, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+				vst1q_f32(base + 2 * BATCH_TRANSFORM_OUTPUT_FLOATS, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+				vst1q_f32(base + 3 * BATCH_TRANSFORM_OUTPUT_FLOATS, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+			}
+		}
+	};
+
+#include "BatchTransformKernel.inl"
+}
+
+size_t BatchTransformNEON(const BatchTransformParams& params, size_t begin, size_t end)
+{
+	return RunBatchTransform<NEONOps>(params, begin, end);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "BatchTransformKernels.h"
+
+#if defined(BATCH_TRANSFORM_X86)
+
+#include <emmintrin.h>
+
+namespace
+{
+	struct SSEOps
+	{
+		typedef __m128 Vec;
+		static const size_t WIDTH = 4;
+
+		static inline Vec Set1(float value) { return _mm_set1_ps(value); }
+		static inline Vec Load(const float* data) { return _mm_loadu_ps(data); }
+		static inline Vec Add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+		static inline Vec Sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+		static inline Vec Mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+		static inline Vec Div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+
+		// Results are one register per matrix element, transposing groups of four
+		// turns them into one vec4 per object
+		static inline void Store(const Vec* result, float* outputs)
+		{
+			for (int group = 0; group < BATCH_TRANSFORM_OUTPUT_FLOATS / 4; group++)
+			{
+				Vec r0 = result[group * 4 + 0];
+				Vec r1 = result[group * 4 + 1];
+				Vec r2 = result[group * 4 + 2];
+				Vec r3 = result[group * 4 + 3];
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				_mm_storeu_ps(outputs + 0 * BATCH_TRANSFORM_OUTPUT_FLOATS + group * 4, r0);
+				_mm_storeu_ps(outputs + 1 * BATCH_TRANSFORM_OUTPUT_FLOATS + group * 4, r1);
+				_mm_storeu_ps(outputs + 2 * BATCH_TRANSFORM_OUTPUT_FLOATS + group * 4, r2);
+				_mm_storeu_ps(outputs + 3 * BATCH_TRANSFORM_OUTPUT_FLOATS + group * 4, r3);
+			}
+		}
+	};
+
+#include "BatchTransformKernel.inl"
+}
+
+size_t BatchTransformSSE(const BatchTransformParams& params, size_t begin, size_t end)
+{
+	return RunBatchTransform<SSEOps>(params, begin, end);
+}
+
+#endif
@@ -10,8 +10,17 @@ uniform mat4 u_ModelMat;
 uniform mat4 u_ViewMat;
 uniform mat4 u_ProjectionMat;
 
+// Compressed vertices: unorm16 positions inside the mesh AABB, the normals are not shaded yet
+uniform bool u_IsCompressed;
+uniform vec3 u_PositionBias;
+uniform vec3 u_PositionScale;
+
 void main()
 {
-	gl_Position = u_ProjectionMat * u_ViewMat * u_ModelMat * vec4(vPosition, 1.0);
+	vec3 position = vPosition;
+	if (u_IsCompressed)
+		position = u_PositionBias + vPosition * u_PositionScale;
+
+	gl_Position = u_ProjectionMat * u_ViewMat * u_ModelMat * vec4(position, 1.0);
 	TexCoord = vTexCoord;
 };
\ No newline at end of file
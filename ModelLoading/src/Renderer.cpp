@@ -14,15 +14,31 @@
 #include "core/imgui/ImGuiWindow.h"
 #include "core/Shader.h"
 #include "core/Scene.h"
+#include "core/GpuDeletionQueue.h"
 
 #define WINDOW_TITLE "OpenGL Renderer"
 #define WINDOW_WIDTH 1280
 #define WINDOW_HEIGHT 720
 
+// Frames still drawn after the last change: the simulation builds one frame ahead
+// and ImGui needs one more to settle
+#define REDRAW_FRAMES 3
+// Longest wait for events while idle
+#define IDLE_WAIT_SECONDS 0.5
+// Frame rate cap of an unfocused window
+#define UNFOCUSED_FRAME_RATE 10.0
+
 // Window
 ImGuiWindow imGui;
 GLFWwindow* window;
 bool isFullscreen = false;
+bool isWindowFocused = true;
+
+// Event-driven rendering: frames are only drawn after input, an edit or while
+// something is still changing
+bool isEventDriven = true;
+int redrawFrames = REDRAW_FRAMES;
+double lastDrawTime = 0.0;
 
 // Mouse input
 float lastX = 0.0f;
@@ -40,12 +56,18 @@ static void Shutdown();
 static void UpdatePerformanceDisplay();
 static void ProcessCameraInput();
 static void ClearBuffers();
+static void RequestRedraw();
+static void WaitForEvents();
+static bool ShouldDraw();
 
 static void OnResize(GLFWwindow* window, int width, int height);
 static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, int mods);
 static void OnMouse(GLFWwindow* window, double xpos, double ypos);
 static void OnScroll(GLFWwindow* window, double xoffset, double yoffset);
 static void OnMouseButton(GLFWwindow* window, int button, int action, int mods);
+static void OnFocus(GLFWwindow* window, int focused);
+static void OnIconify(GLFWwindow* window, int iconified);
+static void OnRefresh(GLFWwindow* window);
 
 static GLFWwindow* CreateWindow();
 static void SetWindowIcon(std::string path);
@@ -59,21 +81,49 @@ int main()
 	
 	Shader shader("res/shaders/default.vert", "res/shaders/default.frag");
 
+	// From here on the scene is read by the simulation thread, edits hold its mutex
+	scene->StartSimulation();
+
 	while (!glfwWindowShouldClose(window))
 	{
-		glfwPollEvents();
+		// An idle editor sleeps until an event arrives. Not under the scene mutex, the
+		// simulation keeps building meanwhile: callbacks editing the scene lock it themselves.
+		WaitForEvents();
 
-		UpdatePerformanceDisplay();
-		imGui.Update(isCursorDisabled, scene.get());
-		ProcessCameraInput();
+		{
+			std::lock_guard<std::mutex> lock(scene->GetMutex());
+
+			UpdatePerformanceDisplay();
+			imGui.Update(isCursorDisabled, scene.get());
+			ProcessCameraInput();
+
+			// Held keys, a dragged widget and imports keep the frames coming
+			if (scene->HasPendingChanges() || imGui.IsActive())
+				RequestRedraw();
+		}
+
+		if (!ShouldDraw())
+		{
+			imGui.EndFrame();
+			continue;
+		}
 
 		ClearBuffers();
 
+		// Draw the last frame built by the simulation, the next one is built meanwhile
 		scene->Draw(shader);
 		imGui.Render();
 		glfwSwapBuffers(window);
+
+		// Models removed this frame are deleted once the GPU is done with them
+		GpuDeletionQueue::Get().EndFrame();
 	}
 
+	// The scene is released while the context is still current so its GL objects are actually deleted
+	scene->StopSimulation();
+	scene.reset();
+	GpuDeletionQueue::Get().Flush();
+
 	Shutdown();
 	return 0;
 }
@@ -122,7 +172,11 @@ static int Init()
 	glfwSetCursorPosCallback(window, OnMouse);
 	glfwSetScrollCallback(window, OnScroll);
 	glfwSetMouseButtonCallback(window, OnMouseButton);
+	glfwSetWindowFocusCallback(window, OnFocus);
+	glfwSetWindowIconifyCallback(window, OnIconify);
+	glfwSetWindowRefreshCallback(window, OnRefresh);
 
+	// Installed after the callbacks above, ImGui forwards the events to them
 	imGui.Init(window);
 	
 	return 1;
@@ -175,13 +229,63 @@ static void ClearBuffers()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
+static void RequestRedraw()
+{
+	redrawFrames = REDRAW_FRAMES;
+}
+
+static void WaitForEvents()
+{
+	double waitStart = glfwGetTime();
+	if (glfwGetWindowAttrib(window, GLFW_ICONIFIED) || (isEventDriven && redrawFrames == 0))
+	{
+		// Idle, the last frames were drawn so the simulation has nothing left to build
+		glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+
+		// Not frame time, the camera would jump on the next key press
+		timer.Skip(static_cast<float>(glfwGetTime() - waitStart));
+	}
+	else if (!isWindowFocused && lastDrawTime + 1.0 / UNFOCUSED_FRAME_RATE > waitStart)
+	{
+		// Sleeps until the next frame of the capped rate, events still wake it up
+		glfwWaitEventsTimeout(lastDrawTime + 1.0 / UNFOCUSED_FRAME_RATE - waitStart);
+	}
+	else
+	{
+		glfwPollEvents();
+	}
+}
+
+static bool ShouldDraw()
+{
+	// Nothing is visible, the framebuffer may even be empty
+	if (glfwGetWindowAttrib(window, GLFW_ICONIFIED))
+		return false;
+
+	if (isEventDriven && redrawFrames == 0)
+		return false;
+
+	// Events arriving between two frames of the capped rate wait for the next one
+	double now = glfwGetTime();
+	if (!isWindowFocused && now - lastDrawTime < 1.0 / UNFOCUSED_FRAME_RATE)
+		return false;
+
+	if (redrawFrames > 0)
+		redrawFrames--;
+	lastDrawTime = now;
+	return true;
+}
+
 static void OnResize(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	RequestRedraw();
 }
 
 static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+	RequestRedraw();
+
 	switch (key)
 	{
 		case GLFW_KEY_ESCAPE:
@@ -214,6 +318,18 @@ static void OnKeyboard(GLFWwindow* window, int key, int scancode, int action, in
 
 			break;
 		}
+		case GLFW_KEY_R:
+		{
+			if (!isCursorDisabled)
+				break;
+
+			if (action == GLFW_PRESS)
+			{
+				isEventDriven = !isEventDriven;
+				logger.Info(std::string("Event-driven rendering: ") + (isEventDriven ? "ON" : "OFF"));
+			}
+			break;
+		}
 	}
 }
 
@@ -232,17 +348,30 @@ static void OnMouse(GLFWwindow* window, double xpos, double ypos)
 	lastY = ypos;
 
 	if (isCursorDisabled)
+	{
+		std::lock_guard<std::mutex> lock(scene->GetMutex());
 		camera.ProcessMouseMovement(xOffset, yOffset);
+	}
+
+	// Hovering the UI changes it too
+	RequestRedraw();
 }
 
 static void OnScroll(GLFWwindow* window, double xoffset, double yoffset)
 {
 	if (isCursorDisabled)
+	{
+		std::lock_guard<std::mutex> lock(scene->GetMutex());
 		camera.UpdateFOV(yoffset);
+	}
+
+	RequestRedraw();
 }
 
 static void OnMouseButton(GLFWwindow* window, int button, int action, int mods)
 {
+	RequestRedraw();
+
 	if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
 	{
 		if (!isCursorDisabled)
@@ -258,6 +387,23 @@ static void OnMouseButton(GLFWwindow* window, int button, int action, int mods)
 	}
 }
 
+static void OnFocus(GLFWwindow* window, int focused)
+{
+	isWindowFocused = focused == GLFW_TRUE;
+	RequestRedraw();
+}
+
+static void OnIconify(GLFWwindow* window, int iconified)
+{
+	RequestRedraw();
+}
+
+static void OnRefresh(GLFWwindow* window)
+{
+	// Uncovered or resized, the last frame is gone
+	RequestRedraw();
+}
+
 static GLFWwindow* CreateWindow()
 {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -0,0 +1,89 @@
+#include "GpuDeletionQueue.h"
+
+#include <algorithm>
+
+GpuDeletionQueue& GpuDeletionQueue::Get()
+{
+	// Never destroyed: resources owned by globals are enqueued during static destruction
+	static GpuDeletionQueue* instance = new GpuDeletionQueue();
+	return *instance;
+}
+
+void GpuDeletionQueue::Enqueue(ResourceType type, unsigned int id)
+{
+	if (id != 0)
+		m_Current.push_back({ type, id });
+}
+
+void GpuDeletionQueue::EndFrame(size_t budget)
+{
+	if (!m_Current.empty())
+	{
+		Batch batch;
+		batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		batch.resources.swap(m_Current);
+		batch.released = 0;
+		m_Batches.push_back(std::move(batch));
+	}
+
+	// Batches are fenced in order, the first one still in flight stops the walk
+	while (budget > 0 && !m_Batches.empty())
+	{
+		Batch& batch = m_Batches.front();
+		if (batch.fence)
+		{
+			GLenum status = glClientWaitSync(batch.fence, 0, 0);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+				break;
+
+			glDeleteSync(batch.fence);
+			batch.fence = nullptr;
+		}
+
+		size_t count = std::min(budget, batch.resources.size() - batch.released);
+		Release(batch.resources.data() + batch.released, count);
+		batch.released += count;
+		budget -= count;
+
+		if (batch.released == batch.resources.size())
+			m_Batches.pop_front();
+	}
+}
+
+void GpuDeletionQueue::Flush()
+{
+	glFinish();
+
+	for (auto& batch : m_Batches)
+	{
+		if (batch.fence)
+			glDeleteSync(batch.fence);
+		Release(batch.resources.data() + batch.released, batch.resources.size() - batch.released);
+	}
+	m_Batches.clear();
+
+	Release(m_Current.data(), m_Current.size());
+	m_Current.clear();
+}
+
+size_t GpuDeletionQueue::GetPendingCount() const
+{
+	size_t count = m_Current.size();
+	for (const auto& batch : m_Batches)
+		count += batch.resources.size() - batch.released;
+	return count;
+}
+
+void GpuDeletionQueue::Release(const Resource* resources, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		switch (resources[i].type)
+		{
+		case ResourceType::BUFFER: glDeleteBuffers(1, &resources[i].id); break;
+		case ResourceType::VERTEX_ARRAY: glDeleteVertexArrays(1, &resources[i].id); break;
+		case ResourceType::TEXTURE: glDeleteTextures(1, &resources[i].id); break;
+		case ResourceType::PROGRAM: glDeleteProgram(resources[i].id); break;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// Objects released per frame by default, large unloads are spread over several frames
+#define GPU_DELETION_BUDGET 256
+
+// Defers the deletion of GL objects until the GPU is done with every frame that may
+// still reference them. Deletions requested during a frame are fenced at the end of
+// that frame and only issued once the fence has signalled.
+class GpuDeletionQueue
+{
+public:
+	enum class ResourceType
+	{
+		BUFFER = 0,
+		VERTEX_ARRAY,
+		TEXTURE,
+		PROGRAM
+	};
+
+public:
+	static GpuDeletionQueue& Get();
+
+	// Only records the object, safe to call from destructors without a context
+	void Enqueue(ResourceType type, unsigned int id);
+
+	// Fences the deletions of the frame that just ended and releases at most budget
+	// objects from the frames the GPU has finished
+	void EndFrame(size_t budget = GPU_DELETION_BUDGET);
+
+	// Waits for the GPU and releases everything, the context must still be current
+	void Flush();
+
+	size_t GetPendingCount() const;
+
+private:
+	struct Resource
+	{
+		ResourceType type;
+		unsigned int id;
+	};
+
+	struct Batch
+	{
+		GLsync fence;
+		std::vector<Resource> resources;
+		size_t released;
+	};
+
+	std::vector<Resource> m_Current;
+	std::deque<Batch> m_Batches;
+
+private:
+	GpuDeletionQueue() = default;
+	GpuDeletionQueue(const GpuDeletionQueue&) = delete;
+	GpuDeletionQueue& operator=(const GpuDeletionQueue&) = delete;
+
+	void Release(const Resource* resources, size_t count);
+};
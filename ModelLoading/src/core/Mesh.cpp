@@ -5,13 +5,123 @@
 
 #include <glm/glm.hpp>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
-	: vertices(vertices), indices(indices), textures(textures)
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	unsigned int PackSnorm10(float value)
+	{
+		int quantized = static_cast<int>(std::round(glm::clamp(value, -1.0f, 1.0f) * 511.0f));
+		return static_cast<unsigned int>(quantized) & 0x3FF;
+	}
+
+	// Octahedral mapping, the inverse lives in default.vert
+	unsigned int EncodeNormal(const glm::vec3& normal)
+	{
+		float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (sum == 0.0f)
+			return 0;
+
+		glm::vec2 encoded = glm::vec2(normal.x, normal.y) / sum;
+		if (normal.z < 0.0f)
+		{
+			glm::vec2 folded = glm::vec2(1.0f) - glm::abs(glm::vec2(encoded.y, encoded.x));
+			encoded.x = encoded.x >= 0.0f ? folded.x : -folded.x;
+			encoded.y = encoded.y >= 0.0f ? folded.y : -folded.y;
+		}
+
+		return PackSnorm10(encoded.x) | (PackSnorm10(encoded.y) << 10);
+	}
+}
+
+Mesh::Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<Texture>&& textures, unsigned int materialIndex)
+	: vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)), materialIndex(materialIndex), node(0),
+	m_BaseVertex(0), m_IndexOffset(0), m_IndexCount(0), m_IndexType(GL_UNSIGNED_INT),
+	m_IsCompressed(false), m_PositionBias(0.0f), m_PositionScale(1.0f)
+{
+}
+
+void Mesh::AppendVertices(std::vector<Vertex>& vertexData)
 {
-	SetupMesh();
+	m_BaseVertex = static_cast<int>(vertexData.size());
+	m_IsCompressed = false;
+	vertexData.insert(vertexData.end(), vertices.begin(), vertices.end());
 }
 
-void Mesh::Draw(Shader& shader)
+void Mesh::AppendCompressedVertices(std::vector<CompressedVertex>& vertexData)
+{
+	m_BaseVertex = static_cast<int>(vertexData.size());
+	m_IsCompressed = true;
+	if (vertices.empty())
+		return;
+
+	// Positions are stored relative to the mesh AABB, the shader scales them back
+	glm::vec3 minPosition(vertices[0].position);
+	glm::vec3 maxPosition(vertices[0].position);
+	for (const auto& vertex : vertices)
+	{
+		minPosition = glm::min(minPosition, vertex.position);
+		maxPosition = glm::max(maxPosition, vertex.position);
+	}
+
+	m_PositionBias = minPosition;
+	m_PositionScale = maxPosition - minPosition;
+	glm::vec3 invScale(
+		m_PositionScale.x > 0.0f ? 1.0f / m_PositionScale.x : 0.0f,
+		m_PositionScale.y > 0.0f ? 1.0f / m_PositionScale.y : 0.0f,
+		m_PositionScale.z > 0.0f ? 1.0f / m_PositionScale.z : 0.0f);
+
+	for (const auto& vertex : vertices)
+	{
+		glm::vec3 normalized = glm::clamp((vertex.position - m_PositionBias) * invScale, 0.0f, 1.0f);
+
+		CompressedVertex compressed;
+		compressed.position[0] = static_cast<unsigned short>(std::round(normalized.x * 65535.0f));
+		compressed.position[1] = static_cast<unsigned short>(std::round(normalized.y * 65535.0f));
+		compressed.position[2] = static_cast<unsigned short>(std::round(normalized.z * 65535.0f));
+		compressed.position[3] = 0;
+		compressed.normal = EncodeNormal(vertex.normal);
+		compressed.texCoords = glm::packHalf2x16(vertex.texCoords);
+		vertexData.push_back(compressed);
+	}
+}
+
+void Mesh::AppendIndices(std::vector<unsigned char>& indexData)
+{
+	m_IndexCount = static_cast<unsigned int>(indices.size());
+
+	// Indices are relative to the base vertex, so 16 bits are enough whenever
+	// this submesh alone has at most 65536 vertices
+	if (vertices.size() <= 65536)
+	{
+		m_IndexType = GL_UNSIGNED_SHORT;
+		m_IndexOffset = indexData.size();
+
+		std::vector<unsigned short> shortIndices(indices.begin(), indices.end());
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(shortIndices.data());
+		indexData.insert(indexData.end(), bytes, bytes + shortIndices.size() * sizeof(unsigned short));
+	}
+	else
+	{
+		// 32-bit indices must start on a 4 byte boundary
+		indexData.resize((indexData.size() + 3) & ~static_cast<size_t>(3));
+		m_IndexType = GL_UNSIGNED_INT;
+		m_IndexOffset = indexData.size();
+
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(indices.data());
+		indexData.insert(indexData.end(), bytes, bytes + indices.size() * sizeof(unsigned int));
+	}
+}
+
+void Mesh::ReleaseGeometry()
+{
+	// swap with empty vectors, clear() would keep the capacity
+	std::vector<Vertex>().swap(vertices);
+	std::vector<unsigned int>().swap(indices);
+}
+
+void Mesh::BindTextures(Shader& shader) const
 {
 	unsigned short diffuseCount = 1;
 	unsigned short specularCount = 1;
@@ -41,32 +151,15 @@ void Mesh::Draw(Shader& shader)
 		}
 		glBindTexture(GL_TEXTURE_2D, textures[i].id);
 	}
-
-	glBindVertexArray(m_VAO);
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-	glBindVertexArray(0);
 }
 
-void Mesh::SetupMesh()
+void Mesh::Draw(Shader& shader) const
 {
-	glGenVertexArrays(1, &m_VAO);
-	glGenBuffers(1, &m_VBO);
-	glGenBuffers(1, &m_EBO);
-
-	glBindVertexArray(m_VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+	if (m_IsCompressed)
+	{
+		shader.SetVec3("u_PositionBias", m_PositionBias);
+		shader.SetVec3("u_PositionScale", m_PositionScale);
+	}
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_IndexCount), m_IndexType, (void*)m_IndexOffset, m_BaseVertex);
 }
\ No newline at end of file
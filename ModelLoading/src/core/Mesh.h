@@ -20,6 +20,14 @@ struct Vertex
 	glm::vec2 texCoords;
 };
 
+// 16 byte GPU-side vertex used when a model is imported with compressed vertices
+struct CompressedVertex
+{
+	unsigned short position[4];		// unorm16 inside the mesh AABB, w is padding
+	unsigned int normal;			// octahedral snorm10 x/y in GL_INT_2_10_10_10_REV
+	unsigned int texCoords;			// two half floats
+};
+
 struct Texture
 {
 	unsigned int id;
@@ -27,21 +35,45 @@ struct Texture
 	std::string path;
 };
 
+// A submesh of a Model. Geometry lives in the model's shared vertex/index buffers,
+// the mesh only remembers where its range starts.
 class Mesh
 {
 public:
 	std::vector<Vertex> vertices;
 	std::vector<unsigned int> indices;
 	std::vector<Texture> textures;
+	unsigned int materialIndex;
+	unsigned int node;					// TransformGraph node of the model this mesh is attached to
 
 public:
-	Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
-	
-	void Draw(Shader& shader);
+	Mesh(std::vector<Vertex>&& vertices, std::vector<unsigned int>&& indices, std::vector<Texture>&& textures, unsigned int materialIndex = 0);
 
-private:
-	unsigned int m_VBO, m_EBO, m_VAO;
+	// Move-only, the geometry can be large
+	Mesh(const Mesh&) = delete;
+	Mesh& operator=(const Mesh&) = delete;
+	Mesh(Mesh&&) = default;
+	Mesh& operator=(Mesh&&) = default;
+
+	// Append this mesh to the shared buffers being built by the model and record its range
+	void AppendVertices(std::vector<Vertex>& vertexData);
+	void AppendCompressedVertices(std::vector<CompressedVertex>& vertexData);
+	void AppendIndices(std::vector<unsigned char>& indexData);
+
+	// Frees vertices and indices, the mesh can still be drawn from the shared buffers
+	void ReleaseGeometry();
+
+	// Expects the model's VAO to be bound
+	void BindTextures(Shader& shader) const;
+	void Draw(Shader& shader) const;
 
 private:
-	void SetupMesh();
-};
+	int m_BaseVertex;
+	size_t m_IndexOffset;
+	unsigned int m_IndexCount;
+	unsigned int m_IndexType;
+
+	bool m_IsCompressed;
+	glm::vec3 m_PositionBias;
+	glm::vec3 m_PositionScale;
+};
\ No newline at end of file
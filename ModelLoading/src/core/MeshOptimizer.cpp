@@ -0,0 +1,309 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace
+{
+	struct VertexHasher
+	{
+		size_t operator()(const Vertex& vertex) const
+		{
+			// FNV-1a over the raw bytes, Vertex has no padding
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+			size_t hash = 2166136261u;
+			for (size_t i = 0; i < sizeof(Vertex); i++)
+			{
+				hash ^= bytes[i];
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	};
+
+	struct VertexEqual
+	{
+		bool operator()(const Vertex& a, const Vertex& b) const
+		{
+			return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	struct Cluster
+	{
+		size_t firstTriangle;
+		size_t triangleCount;
+		float sortKey;
+	};
+
+	int SkipDeadEnd(const std::vector<unsigned int>& liveCount, std::vector<unsigned int>& deadEnd, size_t& cursor)
+	{
+		// Most recently referenced vertices first, they are the most likely to still be in the cache
+		while (!deadEnd.empty())
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveCount[vertex] > 0)
+				return static_cast<int>(vertex);
+		}
+
+		// Otherwise the next vertex in input order that still has triangles
+		while (cursor < liveCount.size())
+		{
+			if (liveCount[cursor] > 0)
+				return static_cast<int>(cursor++);
+			cursor++;
+		}
+
+		return -1;
+	}
+}
+
+void MeshOptimizer::WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	std::unordered_map<Vertex, unsigned int, VertexHasher, VertexEqual> unique;
+	unique.reserve(vertices.size());
+
+	std::vector<unsigned int> remap(vertices.size());
+	std::vector<Vertex> welded;
+	welded.reserve(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		auto result = unique.emplace(vertices[i], static_cast<unsigned int>(welded.size()));
+		if (result.second)
+			welded.push_back(vertices[i]);
+		remap[i] = result.first->second;
+	}
+
+	for (auto& index : indices)
+		index = remap[index];
+
+	vertices.swap(welded);
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Vertex -> triangles adjacency, stored as one flat array with per-vertex offsets
+	std::vector<unsigned int> liveCount(vertexCount, 0);
+	for (auto index : indices)
+		liveCount[index]++;
+
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + liveCount[v];
+
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		for (size_t k = 0; k < 3; k++)
+			adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+	}
+
+	std::vector<unsigned int> timestamps(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+	deadEnd.reserve(indices.size());
+	result.reserve(indices.size());
+
+	unsigned int time = cacheSize + 1;
+	size_t cursor = 0;
+	int fanning = static_cast<int>(indices[0]);
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+		{
+			unsigned int triangle = adjacency[i];
+			if (emitted[triangle])
+				continue;
+
+			for (size_t k = 0; k < 3; k++)
+			{
+				unsigned int vertex = indices[triangle * 3 + k];
+				result.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCount[vertex]--;
+
+				if (time - timestamps[vertex] > cacheSize)
+					timestamps[vertex] = time++;
+			}
+
+			emitted[triangle] = true;
+		}
+
+		// Next fanning vertex: the oldest candidate that will still be in the cache
+		// once all of its remaining triangles are emitted
+		int best = -1;
+		int bestPriority = -1;
+		for (auto vertex : candidates)
+		{
+			if (liveCount[vertex] == 0)
+				continue;
+
+			int priority = 0;
+			if (time - timestamps[vertex] + 2 * liveCount[vertex] <= cacheSize)
+				priority = static_cast<int>(time - timestamps[vertex]);
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				best = static_cast<int>(vertex);
+			}
+		}
+
+		fanning = best >= 0 ? best : SkipDeadEnd(liveCount, deadEnd, cursor);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, unsigned int cacheSize)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2)
+		return;
+
+	// A triangle whose three vertices all miss the cache is where Tipsify restarted,
+	// splitting there keeps the cache efficiency of every cluster intact
+	std::vector<Cluster> clusters;
+	std::vector<int> insertedAt(vertices.size(), -static_cast<int>(cacheSize) - 1);
+	int misses = 0;
+
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		int triangleMisses = 0;
+		for (size_t k = 0; k < 3; k++)
+		{
+			unsigned int vertex = indices[t * 3 + k];
+			if (misses - insertedAt[vertex] >= static_cast<int>(cacheSize))
+			{
+				insertedAt[vertex] = ++misses;
+				triangleMisses++;
+			}
+		}
+
+		if (t == 0 || triangleMisses == 3)
+			clusters.push_back({ t, 0, 0.0f });
+		clusters.back().triangleCount++;
+	}
+
+	if (clusters.size() < 2)
+		return;
+
+	// Area weighted centroid of the whole mesh
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const glm::vec3& a = vertices[indices[t * 3 + 0]].position;
+		const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+		const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+		float area = glm::length(glm::cross(b - a, c - a));
+		meshCentroid += area * (a + b + c) / 3.0f;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	// Clusters that face away from the centre are likely to occlude the others
+	for (auto& cluster : clusters)
+	{
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (size_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++)
+		{
+			const glm::vec3& a = vertices[indices[t * 3 + 0]].position;
+			const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+			const glm::vec3& c = vertices[indices[t * 3 + 2]].position;
+			glm::vec3 n = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(n);
+
+			centroid += triangleArea * (a + b + c) / 3.0f;
+			normal += n;
+			area += triangleArea;
+		}
+
+		float normalLength = glm::length(normal);
+		if (area > 0.0f && normalLength > 0.0f)
+			cluster.sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(),
+		[](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (const auto& cluster : clusters)
+	{
+		auto begin = indices.begin() + cluster.firstTriangle * 3;
+		result.insert(result.end(), begin, begin + cluster.triangleCount * 3);
+	}
+
+	indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	const unsigned int unused = ~0u;
+	std::vector<unsigned int> remap(vertices.size(), unused);
+	std::vector<Vertex> reordered;
+	reordered.reserve(vertices.size());
+
+	for (auto& index : indices)
+	{
+		if (remap[index] == unused)
+		{
+			remap[index] = static_cast<unsigned int>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices.swap(reordered);
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+{
+	VertexCacheStats stats = { 0.0f, 0.0f };
+	if (indices.empty())
+		return stats;
+
+	// FIFO cache: a vertex is still cached if less than cacheSize misses happened since it was inserted
+	std::vector<int> insertedAt(vertexCount, -static_cast<int>(cacheSize) - 1);
+	std::vector<bool> referenced(vertexCount, false);
+	int misses = 0;
+	size_t uniqueVertices = 0;
+
+	for (auto index : indices)
+	{
+		if (misses - insertedAt[index] >= static_cast<int>(cacheSize))
+			insertedAt[index] = ++misses;
+
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			uniqueVertices++;
+		}
+	}
+
+	stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+	stats.atvr = static_cast<float>(misses) / uniqueVertices;
+	return stats;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "Mesh.h"
+
+// Post-transform cache size assumed by the optimizer and the statistics
+#define VERTEX_CACHE_SIZE 16
+
+struct VertexCacheStats
+{
+	float acmr;		// average cache miss ratio, transformed vertices per triangle (0.5 is ideal)
+	float atvr;		// average transform to vertex ratio, transformed vertices per unique vertex (1.0 is ideal)
+};
+
+// Import-time optimizations for indexed triangle lists.
+// Meant to run in this order: weld, vertex cache, overdraw, vertex fetch.
+class MeshOptimizer
+{
+public:
+	// Merges bitwise identical vertices and rewrites the indices accordingly
+	static void WeldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	// Reorders triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007)
+	static void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+	// Reorders the clusters produced by OptimizeVertexCache so outward facing ones are drawn first,
+	// which lets early-z reject more of the fragments behind them
+	static void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+	// Reorders vertices by first use so the vertex fetch walks memory linearly, drops unused vertices
+	static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+	// Simulates a FIFO post-transform cache over the index buffer
+	static VertexCacheStats AnalyzeVertexCache(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+};
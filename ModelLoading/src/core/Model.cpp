@@ -5,51 +5,88 @@
 #include "common/Logger.hpp"
 
 #include "Shader.h"
+#include "MeshOptimizer.h"
+#include "GpuDeletionQueue.h"
 
-Model::Model(const std::string& path) :
-	isUniformScaling(true),
-	m_TranslationTransform(1.0f), m_RotationTransform(1.0f), m_ScaleTransform(1.0f),
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+
+Model::Model(const std::string& path, bool compressVertices, GeometryRetention retention) :
+	isUniformScaling(true), m_CompressVertices(compressVertices), m_Retention(retention),
+	m_VAO(0), m_VBO(0), m_EBO(0),
 	m_Position(0.0f), m_Rotation(0.0f), m_Scale(1.0f)
 {
+	// Node 0 carries the model transform edited in the UI, the file's hierarchy hangs below it
+	m_Transforms.AddNode(TransformGraph::NO_PARENT, m_Position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), m_Scale);
+
 	LoadFromFile(path);
 }
 
-void Model::Draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection)
+Model::~Model()
+{
+	// The model can be removed mid-frame from the editor, see GpuDeletionQueue
+	GpuDeletionQueue& deletionQueue = GpuDeletionQueue::Get();
+	deletionQueue.Enqueue(GpuDeletionQueue::ResourceType::VERTEX_ARRAY, m_VAO);
+	deletionQueue.Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_VBO);
+	deletionQueue.Enqueue(GpuDeletionQueue::ResourceType::BUFFER, m_EBO);
+	for (const auto& texture : m_LoadedTextures)
+		deletionQueue.Enqueue(GpuDeletionQueue::ResourceType::TEXTURE, texture.id);
+}
+
+void Model::UpdateTransforms(std::vector<glm::mat4>& meshTransforms)
+{
+	// Only subtrees that changed since the last frame are recomputed
+	m_Transforms.Update();
+
+	for (const auto& mesh : m_Meshes)
+		meshTransforms.push_back(m_Transforms.GetWorldTransform(mesh.node));
+}
+
+void Model::Draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4* meshTransforms) const
 {
 	shader.Use();
 
-	shader.SetMat4("u_ModelMat", m_TranslationTransform * m_RotationTransform * m_ScaleTransform);
 	shader.SetMat4("u_ViewMat", view);
 	shader.SetMat4("u_ProjectionMat", projection);
 
+	shader.SetBool("u_IsCompressed", m_CompressVertices);
+
+	glBindVertexArray(m_VAO);
+
+	// Meshes are sorted by material, textures only change between groups
 	for (unsigned int i = 0; i < m_Meshes.size(); i++)
+	{
+		if (i == 0 || m_Meshes[i].materialIndex != m_Meshes[i - 1].materialIndex)
+			m_Meshes[i].BindTextures(shader);
+		if (i == 0 || m_Meshes[i].node != m_Meshes[i - 1].node)
+			shader.SetMat4("u_ModelMat", meshTransforms[i]);
 		m_Meshes[i].Draw(shader);
+	}
+
+	glBindVertexArray(0);
 }
 
 void Model::SetPosition(glm::vec3 position)
 {
-	glm::mat4 m_TranslationTransform = glm::mat4(1.0f);
-	m_TranslationTransform = glm::translate(m_TranslationTransform, position);
-
+	m_Transforms.SetPosition(TransformGraph::ROOT, position);
 	m_Position = position;
 }
 
 void Model::SetRotation(glm::vec3 rotation)
 {
-	m_RotationTransform = glm::mat4(1.0f);
-	m_RotationTransform =
-		glm::rotate(m_RotationTransform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
-		glm::rotate(m_RotationTransform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
-		glm::rotate(m_RotationTransform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::quat orientation =
+		glm::angleAxis(glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
+		glm::angleAxis(glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+		glm::angleAxis(glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
 
+	m_Transforms.SetRotation(TransformGraph::ROOT, orientation);
 	m_Rotation = rotation;
 }
 
 void Model::SetScale(glm::vec3 scale)
 {
-	m_ScaleTransform = glm::mat4(1.0f);
-	m_ScaleTransform = glm::scale(m_ScaleTransform, scale);
-
+	m_Transforms.SetScale(TransformGraph::ROOT, scale);
 	m_Scale = scale;
 }
 
@@ -67,22 +104,44 @@ void Model::LoadFromFile(const std::string& path)
 	m_Directory = path.substr(0, path.find_last_of('\\'));
 	Logger::Get().Info("m_Directory = " + m_Directory);
 
-	ProcessNode(scene->mRootNode, scene);
+	m_Meshes.reserve(scene->mNumMeshes);
+	ProcessNode(scene->mRootNode, scene, TransformGraph::ROOT);
+
+	// Group by material first, then by node so consecutive meshes share u_ModelMat
+	std::stable_sort(m_Meshes.begin(), m_Meshes.end(), [](const Mesh& a, const Mesh& b)
+	{
+		if (a.materialIndex != b.materialIndex)
+			return a.materialIndex < b.materialIndex;
+		return a.node < b.node;
+	});
+
+	SetupBuffers();
 }
 
-void Model::ProcessNode(aiNode* node, const aiScene* scene)
+void Model::ProcessNode(aiNode* node, const aiScene* scene, unsigned int parent)
 {
+	// Local transform relative to the parent node
+	aiVector3D scaling, position;
+	aiQuaternion rotation;
+	node->mTransformation.Decompose(scaling, rotation, position);
+
+	unsigned int transformNode = m_Transforms.AddNode(parent,
+		glm::vec3(position.x, position.y, position.z),
+		glm::quat(rotation.w, rotation.x, rotation.y, rotation.z),
+		glm::vec3(scaling.x, scaling.y, scaling.z));
+
 	// Process all node's meshes
 	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		m_Meshes.push_back(ProcessMesh(mesh, scene));
+		m_Meshes.emplace_back(ProcessMesh(mesh, scene));
+		m_Meshes.back().node = transformNode;
 	}
 	
-	// Process all node's children recursively
+	// Process all node's children recursively, in preorder so the graph stays flat
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		ProcessNode(node->mChildren[i], scene);
+		ProcessNode(node->mChildren[i], scene, transformNode);
 	}
 }
 
@@ -92,51 +151,48 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
 	std::vector<unsigned int> indices;
 	std::vector<Texture> textures;
 
-	// Vertices setup
-	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-	{
-		Vertex vertex;
-		glm::vec3 vector;
+	// Vertices setup, one pass per attribute straight from the Assimp arrays
+	const unsigned int vertexCount = mesh->mNumVertices;
+	vertices.resize(vertexCount);
 
-		// Positions
-		vector.x = mesh->mVertices[i].x;
-		vector.y = mesh->mVertices[i].y;
-		vector.z = mesh->mVertices[i].z;
-		vertex.position = vector;
+	for (unsigned int i = 0; i < vertexCount; i++)
+		vertices[i].position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
 
-		// Normals
-		if (mesh->HasNormals())
-		{
-			vector.x = mesh->mNormals[i].x;
-			vector.y = mesh->mNormals[i].y;
-			vector.z = mesh->mNormals[i].z;
-			vertex.normal = vector;
-		}
-
-		// Texture coordinates
-		if (mesh->HasTextureCoords(0))
-		{
-			glm::vec2 vec;
-			vec.x = mesh->mTextureCoords[0][i].x;
-			vec.y = mesh->mTextureCoords[0][i].y;
-			vertex.texCoords = vec;
-		}
-		else
-		{
-			vertex.texCoords = glm::vec2(0.0f, 0.0f);
-		}
+	if (mesh->HasNormals())
+	{
+		for (unsigned int i = 0; i < vertexCount; i++)
+			vertices[i].normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < vertexCount; i++)
+			vertices[i].normal = glm::vec3(0.0f, 0.0f, 0.0f);
+	}
 
-		vertices.push_back(vertex);
+	if (mesh->HasTextureCoords(0))
+	{
+		const aiVector3D* texCoords = mesh->mTextureCoords[0];
+		for (unsigned int i = 0; i < vertexCount; i++)
+			vertices[i].texCoords = glm::vec2(texCoords[i].x, texCoords[i].y);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < vertexCount; i++)
+			vertices[i].texCoords = glm::vec2(0.0f, 0.0f);
 	}
 
-	// Indices setup
+	// Indices setup (points and lines left over by the triangulation are skipped)
+	indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 	{
-		aiFace face = mesh->mFaces[i];
-		for (unsigned int j = 0; j < face.mNumIndices; j++)
-			indices.push_back(face.mIndices[j]);
+		const aiFace& face = mesh->mFaces[i];
+		if (face.mNumIndices != 3)
+			continue;
+		indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
 	}
 
+	OptimizeMesh(vertices, indices);
+
 	// Material setup
 	if (mesh->mMaterialIndex >= 0)
 	{
@@ -152,7 +208,110 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
 		textures.insert(textures.end(), emissiveMaps.begin(), emissiveMaps.end());
 	}
 
-	return Mesh(vertices, indices, textures);
+	return Mesh(std::move(vertices), std::move(indices), std::move(textures), mesh->mMaterialIndex);
+}
+
+void Model::SetupBuffers()
+{
+	std::vector<Vertex> vertexData;
+	std::vector<CompressedVertex> compressedVertexData;
+	std::vector<unsigned char> indexData;
+
+	// Sized once for the whole model, growing per mesh would copy the staging data repeatedly
+	size_t vertexCount = 0;
+	size_t indexBytes = 0;
+	for (const auto& mesh : m_Meshes)
+	{
+		vertexCount += mesh.vertices.size();
+		// Upper bound, 32-bit indices may also need up to 3 bytes of alignment
+		indexBytes += mesh.indices.size() * sizeof(unsigned int) + 3;
+	}
+
+	if (m_CompressVertices)
+		compressedVertexData.reserve(vertexCount);
+	else
+		vertexData.reserve(vertexCount);
+	indexData.reserve(indexBytes);
+
+	for (auto& mesh : m_Meshes)
+	{
+		if (m_CompressVertices)
+			mesh.AppendCompressedVertices(compressedVertexData);
+		else
+			mesh.AppendVertices(vertexData);
+		mesh.AppendIndices(indexData);
+
+		// Free each mesh as soon as it is copied, so the CPU copy and the
+		// staging data never both hold the whole model
+		if (m_Retention == GeometryRetention::RELEASE_AFTER_UPLOAD)
+			mesh.ReleaseGeometry();
+	}
+
+	glGenVertexArrays(1, &m_VAO);
+	glGenBuffers(1, &m_VBO);
+	glGenBuffers(1, &m_EBO);
+
+	glBindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+
+	size_t vertexBytes;
+	if (m_CompressVertices)
+	{
+		vertexBytes = compressedVertexData.size() * sizeof(CompressedVertex);
+		glBufferData(GL_ARRAY_BUFFER, vertexBytes, compressedVertexData.data(), GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompressedVertex), (void*)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompressedVertex), (void*)offsetof(CompressedVertex, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompressedVertex), (void*)offsetof(CompressedVertex, texCoords));
+	}
+	else
+	{
+		vertexBytes = vertexData.size() * sizeof(Vertex);
+		glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData.data(), GL_STATIC_DRAW);
+
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), indexData.data(), GL_STATIC_DRAW);
+
+	glBindVertexArray(0);
+
+	std::stringstream ss;
+	ss << "Model buffers: " << m_Meshes.size() << " submeshes, "
+	   << vertexBytes / 1024 << " KB vertices, " << indexData.size() / 1024 << " KB indices";
+	Logger::Get().Info(ss.str());
+}
+
+void Model::OptimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	if (indices.empty())
+		return;
+
+	size_t vertexCount = vertices.size();
+	VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+	MeshOptimizer::WeldVertices(vertices, indices);
+	MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+	MeshOptimizer::OptimizeOverdraw(indices, vertices);
+	MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+	VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+
+	std::stringstream ss;
+	ss.precision(3);
+	ss << "Mesh optimized: " << vertexCount << " -> " << vertices.size() << " vertices, "
+	   << "ACMR " << before.acmr << " -> " << after.acmr << ", "
+	   << "ATVR " << before.atvr << " -> " << after.atvr;
+	Logger::Get().Info(ss.str());
 }
 
 std::vector<Texture> Model::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, TextureType typeEnum)
@@ -6,19 +6,36 @@
 #include <glm/glm.hpp>
 
 #include "Mesh.h"
+#include "TransformGraph.h"
 
 class Shader;
 
+// What happens to the CPU copy of the geometry once it is in GPU buffers
+enum class GeometryRetention
+{
+	RELEASE_AFTER_UPLOAD = 0,
+	KEEP					// picking, physics or anything else reading Mesh::vertices/indices
+};
+
 class Model
 {
 public:
 	bool isUniformScaling;
 
 public:
-	Model(const std::string& path);
+	// compressVertices uploads 16 byte quantized vertices instead of the 32 byte float ones
+	Model(const std::string& path, bool compressVertices = false, GeometryRetention retention = GeometryRetention::RELEASE_AFTER_UPLOAD);
+	~Model();
+
+	// Owns GL buffers
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
 
 public:
-	void Draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+	// Recomputes the transforms that changed and appends the world matrix of each mesh
+	void UpdateTransforms(std::vector<glm::mat4>& meshTransforms);
+	// meshTransforms holds one matrix per mesh, as appended by UpdateTransforms
+	void Draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection, const glm::mat4* meshTransforms) const;
 
 	void SetPosition(glm::vec3 position);
 	void SetRotation(glm::vec3 rotation);
@@ -27,23 +44,29 @@ public:
 	inline glm::vec3 GetPosition() const { return m_Position; }
 	inline glm::vec3 GetRotation() const { return m_Rotation; }
 	inline glm::vec3 GetScale() const { return m_Scale; }
+	inline size_t GetMeshCount() const { return m_Meshes.size(); }
 
 private:
 	std::vector<Texture> m_LoadedTextures;
 	std::vector<Mesh> m_Meshes;
 	std::string m_Directory;
+	bool m_CompressVertices;
+	GeometryRetention m_Retention;
+
+	// All submeshes share one VAO and one vertex/index buffer pair
+	unsigned int m_VAO, m_VBO, m_EBO;
 
 	glm::vec3 m_Position;
 	glm::vec3 m_Rotation;
 	glm::vec3 m_Scale;
-	glm::mat4 m_TranslationTransform;
-	glm::mat4 m_RotationTransform;
-	glm::mat4 m_ScaleTransform;
+	TransformGraph m_Transforms;
 
 private:
 	void LoadFromFile(const std::string& path);
-	void ProcessNode(aiNode* node, const aiScene* scene);
+	void ProcessNode(aiNode* node, const aiScene* scene, unsigned int parent);
 	Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
+	void SetupBuffers();
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
 	std::vector<Texture> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, TextureType typeEnum);
 	unsigned int TextureFromFile(const std::string& path);
 };
\ No newline at end of file
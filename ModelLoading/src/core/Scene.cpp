@@ -4,18 +4,133 @@
 #include "common/Logger.hpp"
 
 Scene::Scene() :
-	m_Camera(Camera(CAMERA_RES_WIDTH, CAMERA_RES_HEIGHT, glm::vec3(0.0f, 0.0f, 3.0f)))
+	m_Camera(Camera(CAMERA_RES_WIDTH, CAMERA_RES_HEIGHT, glm::vec3(0.0f, 0.0f, 3.0f))),
+	m_ModelVersion(1),
+	m_BuiltView(1.0f), m_BuiltProjection(1.0f), m_BuiltModelCount(0), m_BuiltModelVersion(0),
+	m_IsSimulating(false), m_IsSnapshotRequested(false)
 {
 }
 
-void Scene::Draw(Shader& shader)
+Scene::~Scene()
+{
+	StopSimulation();
+}
+
+void Scene::StartSimulation()
+{
+	if (m_SimulationThread.joinable())
+		return;
+
+	m_IsSimulating = true;
+	m_SimulationThread = std::thread(&Scene::SimulationLoop, this);
+	RequestSnapshot();
+}
+
+void Scene::StopSimulation()
+{
+	if (!m_SimulationThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_IsSimulating = false;
+	}
+	m_RequestCondition.notify_one();
+	m_SimulationThread.join();
+}
+
+void Scene::SimulationLoop()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_RequestMutex);
+			m_RequestCondition.wait(lock, [this]() { return m_IsSnapshotRequested || !m_IsSimulating; });
+			if (!m_IsSimulating)
+				return;
+			m_IsSnapshotRequested = false;
+		}
+
+		BuildSnapshot();
+	}
+}
+
+void Scene::RequestSnapshot()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_RequestMutex);
+		m_IsSnapshotRequested = true;
+	}
+	m_RequestCondition.notify_one();
+}
+
+void Scene::BuildSnapshot()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	RenderSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+	snapshot.view = m_Camera.GetViewMatrix();
+	snapshot.projection = m_Camera.GetProjectionMatrix();
+	snapshot.modelVersion = m_ModelVersion;
+
+	m_BuiltView = snapshot.view;
+	m_BuiltProjection = snapshot.projection;
+	m_BuiltModelCount = m_Models.size();
+	m_BuiltModelVersion = m_ModelVersion;
+
+	snapshot.models.clear();
+	snapshot.meshTransforms.clear();
 	for (auto& model : m_Models)
 	{
-		model->Draw(shader, m_Camera.GetViewMatrix(), m_Camera.GetProjectionMatrix());
+		model->UpdateTransforms(snapshot.meshTransforms);
+		snapshot.models.push_back(model.get());
+	}
+
+	m_Snapshots.Publish();
+}
+
+void Scene::AcquireSnapshot()
+{
+	if (!m_SimulationThread.joinable())
+	{
+		BuildSnapshot();
+		m_Snapshots.Acquire();
+		return;
+	}
+
+	m_Snapshots.Acquire();
+
+	// Only happens on the first frame and right after a model was removed from the UI
+	while (m_Snapshots.GetReadBuffer().modelVersion != m_ModelVersion)
+	{
+		RequestSnapshot();
+		while (!m_Snapshots.Acquire())
+			std::this_thread::yield();
+	}
+
+	// The next frame is built while this one is submitted
+	RequestSnapshot();
+}
+
+void Scene::Draw(Shader& shader)
+{
+	AcquireSnapshot();
+	const RenderSnapshot& snapshot = m_Snapshots.GetReadBuffer();
+
+	const glm::mat4* meshTransforms = snapshot.meshTransforms.data();
+	for (const Model* model : snapshot.models)
+	{
+		model->Draw(shader, snapshot.view, snapshot.projection, meshTransforms);
+		meshTransforms += model->GetMeshCount();
 	}
 }
 
+bool Scene::HasPendingChanges() const
+{
+	return m_Camera.GetViewMatrix() != m_BuiltView || m_Camera.GetProjectionMatrix() != m_BuiltProjection ||
+		m_Models.size() != m_BuiltModelCount || m_ModelVersion != m_BuiltModelVersion;
+}
+
 void Scene::AddModel(std::unique_ptr<Model> model)
 {
 	m_Models.push_back(std::move(model));
@@ -24,7 +139,10 @@ void Scene::AddModel(std::unique_ptr<Model> model)
 void Scene::RemoveModel(size_t toDelete)
 {
 	if (toDelete < m_Models.size())
+	{
+		m_ModelVersion++;
 		m_Models.erase(m_Models.begin() + toDelete);
+	}
 	else
 		Logger::Get().Error("Invalid index. Index is out of range.");
-}
\ No newline at end of file
+}
@@ -1,27 +1,82 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "Camera.h"
 #include "Model.h"
+#include "TripleBuffer.h"
 
 #define CAMERA_RES_WIDTH 1920	
 #define CAMERA_RES_HEIGHT 1080
 
+// Everything the render thread needs to draw a frame, built by the simulation thread
+struct RenderSnapshot
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	std::vector<const Model*> models;
+	std::vector<glm::mat4> meshTransforms;		// Model::UpdateTransforms of every model, one after the other
+	unsigned int modelVersion;					// Scene::m_ModelVersion when it was built
+
+	RenderSnapshot() : view(1.0f), projection(1.0f), modelVersion(0) {}
+};
+
 class Scene
 {
 public:
 	Scene();
+	~Scene();
 
 public:
+	// The simulation thread builds frame N+1 while the calling thread draws frame N.
+	// Without it, Draw builds the frame itself.
+	void StartSimulation();
+	void StopSimulation();
+
+	// Draws the latest snapshot, must be called on the thread owning the GL context
 	void Draw(Shader& shader);
 	void AddModel(std::unique_ptr<Model> model);
 	void RemoveModel(size_t toDelete);
 	inline Camera& GetCamera() { return m_Camera; }
 	inline std::vector<std::unique_ptr<Model>>& GetModels() { return m_Models; }
 
+	// Whether the camera moved or a model was added or removed since the last snapshot
+	// was built. Hold the mutex while the simulation is running.
+	bool HasPendingChanges() const;
+
+	// Held by the simulation while it reads the scene, anything editing the scene
+	// (input, UI) must hold it while the simulation is running
+	inline std::mutex& GetMutex() { return m_Mutex; }
+
 private:
 	Camera m_Camera;
 	std::vector<std::unique_ptr<Model>> m_Models;
-};
\ No newline at end of file
+
+	// Snapshots point to the models. Removing one bumps the version, snapshots built before are not drawn.
+	unsigned int m_ModelVersion;
+
+	// What the last snapshot was built from
+	glm::mat4 m_BuiltView;
+	glm::mat4 m_BuiltProjection;
+	size_t m_BuiltModelCount;
+	unsigned int m_BuiltModelVersion;
+
+	// Simulation thread and its handoff to the render thread
+	std::mutex m_Mutex;
+	TripleBuffer<RenderSnapshot> m_Snapshots;
+	std::thread m_SimulationThread;
+	std::mutex m_RequestMutex;
+	std::condition_variable m_RequestCondition;
+	bool m_IsSimulating;
+	bool m_IsSnapshotRequested;
+
+private:
+	void SimulationLoop();
+	void RequestSnapshot();
+	void BuildSnapshot();
+	void AcquireSnapshot();
+};
@@ -1,5 +1,7 @@
 #include "Shader.h"
 
+#include "GpuDeletionQueue.h"
+
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
 {
     std::string vertexCode;
@@ -80,6 +82,11 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     glDeleteShader(fragment);
 }
 
+Shader::~Shader()
+{
+    GpuDeletionQueue::Get().Enqueue(GpuDeletionQueue::ResourceType::PROGRAM, m_Program);
+}
+
 void Shader::Use() const
 {
     glUseProgram(m_Program);
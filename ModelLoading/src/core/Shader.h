@@ -14,6 +14,7 @@ class Shader
 {
 	public:
 		Shader(const char* vertexPath, const char* fragmentPath);
+		~Shader();
 		
 		void Use() const;
 		
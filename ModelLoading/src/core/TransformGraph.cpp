@@ -0,0 +1,93 @@
+#include "TransformGraph.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+unsigned int TransformGraph::AddNode(unsigned int parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	unsigned int node = static_cast<unsigned int>(m_Parent.size());
+
+	m_Parent.push_back(parent);
+	m_SubtreeSize.push_back(1);
+	m_Position.push_back(position);
+	m_Rotation.push_back(rotation);
+	m_Scale.push_back(scale);
+	m_World.push_back(glm::mat4(1.0f));
+	m_Dirty.push_back(1);
+	m_AnyDirty = true;
+
+	// Preorder insertion: the new node extends the subtree of every ancestor
+	for (unsigned int ancestor = parent; ancestor != NO_PARENT; ancestor = m_Parent[ancestor])
+		m_SubtreeSize[ancestor]++;
+
+	return node;
+}
+
+void TransformGraph::SetLocalTransform(unsigned int node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	m_Position[node] = position;
+	m_Rotation[node] = rotation;
+	m_Scale[node] = scale;
+	MarkDirty(node);
+}
+
+void TransformGraph::SetPosition(unsigned int node, const glm::vec3& position)
+{
+	m_Position[node] = position;
+	MarkDirty(node);
+}
+
+void TransformGraph::SetRotation(unsigned int node, const glm::quat& rotation)
+{
+	m_Rotation[node] = rotation;
+	MarkDirty(node);
+}
+
+void TransformGraph::SetScale(unsigned int node, const glm::vec3& scale)
+{
+	m_Scale[node] = scale;
+	MarkDirty(node);
+}
+
+void TransformGraph::Update()
+{
+	if (!m_AnyDirty)
+		return;
+
+	const unsigned int nodeCount = static_cast<unsigned int>(m_Parent.size());
+	unsigned int node = 0;
+
+	while (node < nodeCount)
+	{
+		if (!m_Dirty[node])
+		{
+			node++;
+			continue;
+		}
+
+		// Parents precede children, so one forward pass over the subtree is enough
+		unsigned int end = node + m_SubtreeSize[node];
+		for (unsigned int i = node; i < end; i++)
+		{
+			unsigned int parent = m_Parent[i];
+			m_World[i] = parent == NO_PARENT ? ComposeLocal(i) : m_World[parent] * ComposeLocal(i);
+			m_Dirty[i] = 0;
+		}
+
+		node = end;
+	}
+
+	m_AnyDirty = false;
+}
+
+void TransformGraph::MarkDirty(unsigned int node)
+{
+	m_Dirty[node] = 1;
+	m_AnyDirty = true;
+}
+
+glm::mat4 TransformGraph::ComposeLocal(unsigned int node) const
+{
+	glm::mat4 transform = glm::translate(glm::mat4(1.0f), m_Position[node]);
+	transform *= glm::mat4_cast(m_Rotation[node]);
+	return glm::scale(transform, m_Scale[node]);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Node hierarchy stored flat in depth-first preorder: a node's subtree is the
+// contiguous range [node, node + subtreeSize) and parents always come before
+// their children, so world matrices can be rebuilt in a single forward sweep.
+// Only subtrees below a changed node are recomputed.
+class TransformGraph
+{
+public:
+	static const unsigned int ROOT = 0;
+	static const unsigned int NO_PARENT = ~0u;
+
+public:
+	TransformGraph() = default;
+
+	// Nodes must be added in preorder (a parent and then all of its descendants)
+	unsigned int AddNode(unsigned int parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+	void SetLocalTransform(unsigned int node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void SetPosition(unsigned int node, const glm::vec3& position);
+	void SetRotation(unsigned int node, const glm::quat& rotation);
+	void SetScale(unsigned int node, const glm::vec3& scale);
+
+	// Recomputes the world matrices of every dirty subtree
+	void Update();
+
+	inline const glm::mat4& GetWorldTransform(unsigned int node) const { return m_World[node]; }
+	inline unsigned int GetParent(unsigned int node) const { return m_Parent[node]; }
+	inline unsigned int GetSubtreeSize(unsigned int node) const { return m_SubtreeSize[node]; }
+	inline size_t GetNodeCount() const { return m_Parent.size(); }
+
+private:
+	std::vector<unsigned int> m_Parent;
+	std::vector<unsigned int> m_SubtreeSize;
+
+	std::vector<glm::vec3> m_Position;
+	std::vector<glm::quat> m_Rotation;
+	std::vector<glm::vec3> m_Scale;
+
+	std::vector<glm::mat4> m_World;
+	std::vector<unsigned char> m_Dirty;
+	bool m_AnyDirty = false;
+
+private:
+	void MarkDirty(unsigned int node);
+	glm::mat4 ComposeLocal(unsigned int node) const;
+};
@@ -69,6 +69,16 @@ void ImGuiWindow::Render() const
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+void ImGuiWindow::EndFrame() const
+{
+	ImGui::EndFrame();
+}
+
+bool ImGuiWindow::IsActive() const
+{
+	return ImGui::IsAnyItemActive();
+}
+
 void ImGuiWindow::CreateMenuBar(Scene* scene)
 {
 	if (ImGui::BeginMenuBar())
@@ -80,8 +90,9 @@ void ImGuiWindow::CreateMenuBar(Scene* scene)
 				std::string path = FileDialog::Open(m_GlfwWindow, "All Files\0*.*\0\0");
 				Logger::Get().Info(path);
 
-				scene->AddModel(std::move(std::make_unique<Model>(path)));
+				scene->AddModel(std::move(std::make_unique<Model>(path, m_CompressVertices)));
 			}
+			ImGui::MenuItem("Compress vertices on import", NULL, &m_CompressVertices);
 
 			ImGui::EndMenu();
 		}
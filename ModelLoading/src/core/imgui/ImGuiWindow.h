@@ -17,9 +17,14 @@ public:
 	void Shutdown();
 	void Update(bool isCursorDisabled, Scene* scene);
 	void Render() const;
+	// Ends a frame built by Update that is not drawn
+	void EndFrame() const;
+	// Whether a widget is being dragged or typed in, the UI keeps being drawn meanwhile
+	bool IsActive() const;
 
 private:
 	GLFWwindow* m_GlfwWindow = nullptr;
+	bool m_CompressVertices = false;
 
 private:
 	void CreateMenuBar(Scene* scene);